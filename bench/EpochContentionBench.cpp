@@ -0,0 +1,132 @@
+/**
+ * @author Will Bender
+ *
+ ** Reader/writer contention: readers iterate a map every pass while one writer churns it.
+ *
+ * Benchmark thread 0 is the writer, removing a random value and inserting a new one per operation. Every other thread
+ * is a reader, iterating the whole map once per pass. `EpochSlotMap` readers never block the writer, while the
+ * baseline guards a `SlotMap` with a `std::shared_mutex` held for each pass, the lock readers needed before.
+ *
+ * `writes` is the writer's operation rate and `reads` the rate of values visited, summed over every reader.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "EpochSlotMap.hpp"
+#include "PerfCounters.hpp"
+
+namespace
+{
+
+constexpr uint32_t Count = 1 << 14;
+constexpr uint32_t WritesPerIteration = 64;
+
+struct EpochContainer
+{
+    using Key = EpochSlotMap<uint64_t>::Key;
+
+    Key Insert(uint64_t value) { return mMap.Insert(value); }
+    void Remove(Key key) { mMap.Remove(key); }
+
+    uint64_t Sum() const
+    {
+        uint64_t sum = 0;
+        mMap.Read().ForEach([&sum](Key, uint64_t value) { sum += value; });
+        return sum;
+    }
+
+    EpochSlotMap<uint64_t> mMap;
+};
+
+struct LockedContainer
+{
+    using Key = SlotMap<uint64_t>::Key;
+
+    Key Insert(uint64_t value)
+    {
+        std::unique_lock lock(mMutex);
+        return mMap.insert(uint64_t(value)).mKey;
+    }
+    void Remove(Key key)
+    {
+        std::unique_lock lock(mMutex);
+        mMap.remove(key);
+    }
+
+    uint64_t Sum() const
+    {
+        std::shared_lock lock(mMutex);
+        uint64_t sum = 0;
+        for (uint64_t value : mMap)
+            sum += value;
+        return sum;
+    }
+
+    SlotMap<uint64_t> mMap;
+    mutable std::shared_mutex mMutex;
+};
+
+// Shared between the benchmark threads, created and destroyed by thread 0 outside the timed loop
+template<typename C>
+struct Shared
+{
+    static inline std::unique_ptr<C> sContainer;
+    static inline std::vector<typename C::Key> sKeys;
+};
+
+template<typename C>
+void Contention(benchmark::State& state)
+{
+    using S = Shared<C>;
+    if (state.thread_index() == 0)
+    {
+        S::sContainer = std::make_unique<C>();
+        S::sKeys.clear();
+        for (uint32_t i = 0; i < Count; ++i)
+            S::sKeys.push_back(S::sContainer->Insert(i));
+    }
+
+    PerfCounters counters;
+    counters.Start();
+    if (state.thread_index() == 0)
+    {
+        std::mt19937 random(1);
+        std::uniform_int_distribution<uint32_t> pick(0, Count - 1);
+        uint64_t next = Count;
+        for (auto _ : state)
+        {
+            for (uint32_t i = 0; i < WritesPerIteration; ++i)
+            {
+                typename C::Key& key = S::sKeys[pick(random)];
+                S::sContainer->Remove(key);
+                key = S::sContainer->Insert(next++);
+            }
+        }
+        counters.Stop();
+        counters.Report(state, WritesPerIteration);
+        state.counters["writes"] =
+            benchmark::Counter(double(state.iterations()) * WritesPerIteration, benchmark::Counter::kIsRate);
+    }
+    else
+    {
+        for (auto _ : state)
+            benchmark::DoNotOptimize(S::sContainer->Sum());
+        counters.Stop();
+        state.counters["reads"] = benchmark::Counter(double(state.iterations()) * Count, benchmark::Counter::kIsRate);
+    }
+
+    if (state.thread_index() == 0)
+        S::sContainer.reset();
+}
+
+BENCHMARK_TEMPLATE(Contention, EpochContainer)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(Contention, LockedContainer)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,153 @@
+/**
+ * @author Will Bender
+ *
+ ** Bulk import of 1M transforms from an interleaved (AoS) buffer into one column per component (SoA).
+ *
+ * - `PerValue` calls `mCopyConstruct` once per value, the type erased loop available before strided kernels
+ * - `Strided` makes one `mCopyConstructStrided` call per column
+ * - `Typed` is a hand-written loop over the known struct, the fastest a caller with full type information gets
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "MetaTypeRegistry.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY, mZ;
+};
+
+struct Rotation
+{
+    float mX, mY, mZ, mW;
+};
+
+struct Scale
+{
+    float mX, mY, mZ;
+};
+
+// Record of the interleaved source, as loaded from an asset or physics engine
+struct Transform
+{
+    Position mPosition;
+    Rotation mRotation;
+    Scale mScale;
+};
+
+constexpr uint32_t Count = 1 << 20;
+
+struct Import
+{
+    Import() : mSource(Count), mPositions(Count), mRotations(Count), mScales(Count)
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+            mSource[i] = Transform{{float(i), 0, 0}, {0, 0, 0, 1}, {1, 1, 1}};
+    }
+
+    std::vector<Transform> mSource;
+    std::vector<Position> mPositions;
+    std::vector<Rotation> mRotations;
+    std::vector<Scale> mScales;
+};
+
+// Column description of one component within `Transform`
+struct Column
+{
+    const MetaType* mType;
+    size_t mOffset;
+    void* mData;
+};
+
+std::vector<Column> GetColumns(Import& import)
+{
+    return {
+        {&MetaTypeRegistry::Get(MetaTypeRegistry::GetId<Position>()), offsetof(Transform, mPosition),
+         import.mPositions.data()},
+        {&MetaTypeRegistry::Get(MetaTypeRegistry::GetId<Rotation>()), offsetof(Transform, mRotation),
+         import.mRotations.data()},
+        {&MetaTypeRegistry::Get(MetaTypeRegistry::GetId<Scale>()), offsetof(Transform, mScale), import.mScales.data()},
+    };
+}
+
+void PerValue(benchmark::State& state)
+{
+    Import import;
+    std::vector<Column> columns = GetColumns(import);
+    uint8_t* source = reinterpret_cast<uint8_t*>(import.mSource.data());
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (const Column& column : columns)
+        {
+            uint8_t* dst = static_cast<uint8_t*>(column.mData);
+            for (uint32_t i = 0; i < Count; ++i)
+            {
+                column.mType->mCopyConstruct(source + i * sizeof(Transform) + column.mOffset,
+                                             dst + static_cast<size_t>(i) * column.mType->mDataSize, 1);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, Count);
+}
+
+void Strided(benchmark::State& state)
+{
+    Import import;
+    std::vector<Column> columns = GetColumns(import);
+    const uint8_t* source = reinterpret_cast<const uint8_t*>(import.mSource.data());
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (const Column& column : columns)
+        {
+            column.mType->mCopyConstructStrided(source + column.mOffset, sizeof(Transform), column.mData,
+                                                column.mType->mDataSize, Count);
+        }
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, Count);
+}
+
+void Typed(benchmark::State& state)
+{
+    Import import;
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            const Transform& transform = import.mSource[i];
+            import.mPositions[i] = transform.mPosition;
+            import.mRotations[i] = transform.mRotation;
+            import.mScales[i] = transform.mScale;
+        }
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, Count);
+}
+
+BENCHMARK(PerValue)->Unit(benchmark::kMillisecond);
+BENCHMARK(Strided)->Unit(benchmark::kMillisecond);
+BENCHMARK(Typed)->Unit(benchmark::kMillisecond);
+
+} // namespace
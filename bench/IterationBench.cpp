@@ -0,0 +1,136 @@
+/**
+ * @author Will Bender
+ *
+ ** Query iteration over archetype tables against an array-of-structs baseline.
+ *
+ * Entities carry position, velocity, health and 64 bytes of other state, and every scenario integrates position
+ * from velocity. The AoS baseline stores each entity as one struct, so the loop pulls the unused fields through the
+ * cache. The views read only the two columns they request.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY, mZ;
+};
+
+struct Velocity
+{
+    float mX, mY, mZ;
+};
+
+struct Health
+{
+    float mValue;
+};
+
+struct State
+{
+    uint8_t mBytes[64];
+};
+
+struct Object
+{
+    Position mPosition;
+    Velocity mVelocity;
+    Health mHealth;
+    State mState;
+};
+
+constexpr float Step = 1.0f / 60.0f;
+
+void Integrate(Position& position, const Velocity& velocity)
+{
+    position.mX += velocity.mX * Step;
+    position.mY += velocity.mY * Step;
+    position.mZ += velocity.mZ * Step;
+}
+
+Object MakeObject(uint32_t i)
+{
+    return Object{{0, 0, 0}, {float(i), 1, 2}, {100}, {}};
+}
+
+void Aos(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    std::vector<Object> objects;
+    for (uint32_t i = 0; i < count; ++i)
+        objects.push_back(MakeObject(i));
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (Object& object : objects)
+            Integrate(object.mPosition, object.mVelocity);
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, count);
+}
+
+void Populate(World& world, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Object object = MakeObject(i);
+        world.Spawn(object.mPosition, object.mVelocity, object.mHealth, object.mState);
+    }
+}
+
+void ViewForEach(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    World world;
+    Populate(world, count);
+    View<Position, const Velocity> view = world.Query<Position, const Velocity>();
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        view.ForEach([](Position& position, const Velocity& velocity) { Integrate(position, velocity); });
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, count);
+}
+
+void ViewForEachTable(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    World world;
+    Populate(world, count);
+    View<Position, const Velocity> view = world.Query<Position, const Velocity>();
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        view.ForEachTable([](uint32_t rows, const EntityKey*, Position* positions, const Velocity* velocities)
+        {
+            for (uint32_t i = 0; i < rows; ++i)
+                Integrate(positions[i], velocities[i]);
+        });
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, count);
+}
+
+BENCHMARK(Aos)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(ViewForEach)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(ViewForEachTable)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+
+} // namespace
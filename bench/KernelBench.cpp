@@ -0,0 +1,93 @@
+/**
+ * @author Will Bender
+ *
+ ** Overhead of indirect MetaType kernels against inlined `Typed<T>` kernels, for 4, 16 and 64 byte components.
+ *
+ * Each scenario copy-assigns 4096 values between two arrays that stay in cache:
+ *
+ * - `IndirectPerValue` calls `mCopyAssign` once per value, as row-at-a-time type erased code does
+ * - `IndirectPerArray` calls `mCopyAssign` once for the whole array
+ * - `InlinedPerValue` calls `Typed<T>::CopyAssign` once per value, which the compiler inlines
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "MetaTypeRegistry.hpp"
+
+namespace
+{
+
+template<uint32_t Size>
+struct Bytes
+{
+    uint32_t mWords[Size / 4];
+};
+
+constexpr uint32_t Count = 4096;
+
+template<typename T, typename F>
+void CopyValues(benchmark::State& state, F&& copy)
+{
+    std::vector<T> src(Count), dst(Count);
+    for (uint32_t i = 0; i < Count; ++i)
+        src[i].mWords[0] = i;
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        copy(src.data(), dst.data());
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, Count);
+}
+
+template<typename T>
+const MetaType& GetType()
+{
+    return MetaTypeRegistry::Get(MetaTypeRegistry::GetId<T>());
+}
+
+template<typename T>
+void IndirectPerValue(benchmark::State& state)
+{
+    const MetaType& type = GetType<T>();
+    CopyValues<T>(state, [&type](T* src, T* dst)
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+            type.mCopyAssign(src + i, dst + i, 1);
+    });
+}
+
+template<typename T>
+void IndirectPerArray(benchmark::State& state)
+{
+    const MetaType& type = GetType<T>();
+    CopyValues<T>(state, [&type](T* src, T* dst) { type.mCopyAssign(src, dst, Count); });
+}
+
+template<typename T>
+void InlinedPerValue(benchmark::State& state)
+{
+    CopyValues<T>(state, [](T* src, T* dst)
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+            Typed<T>::CopyAssign(src + i, dst + i, 1);
+    });
+}
+
+#define KERNEL_BENCH(Size)                                                                                            \
+    BENCHMARK_TEMPLATE(IndirectPerValue, Bytes<Size>);                                                                \
+    BENCHMARK_TEMPLATE(IndirectPerArray, Bytes<Size>);                                                                \
+    BENCHMARK_TEMPLATE(InlinedPerValue, Bytes<Size>)
+
+KERNEL_BENCH(4);
+KERNEL_BENCH(16);
+KERNEL_BENCH(64);
+
+} // namespace
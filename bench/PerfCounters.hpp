@@ -0,0 +1,161 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @author Will Bender
+ *
+ ** Hardware counters for benchmarks, read with `perf_event_open`.
+ */
+
+/*
+ ** Counts hardware events of the calling thread around a benchmark loop.
+ *
+ * Events that cannot be opened (non Linux builds, `perf_event_paranoid` above 2, virtual machines without a PMU) are
+ * skipped, and the benchmark only reports time. Counts include setup done between `Start` and `Stop`, so keep that
+ * outside of the measured region.
+ *
+ *     PerfCounters counters;
+ *     counters.Start();
+ *     for (auto _ : state) { ... }
+ *     counters.Stop();
+ *     counters.Report(state, operationsPerIteration);
+ */
+class PerfCounters
+{
+public:
+    enum Event : uint32_t
+    {
+        CacheMisses,
+        CacheReferences,
+        BranchMisses,
+        Instructions,
+        EventCount
+    };
+
+    PerfCounters();
+    PerfCounters(const PerfCounters& other) = delete;
+    PerfCounters& operator=(const PerfCounters& other) = delete;
+    ~PerfCounters();
+
+    // Reset and start every available event
+    void Start();
+    // Stop every event and read its count
+    void Stop();
+
+    /**
+     * Add `time_per_op` and every available event per operation to the benchmark counters
+     * @param state Benchmark state, after its loop finished
+     * @param operations Operations done by each iteration of the loop
+     */
+    void Report(benchmark::State& state, uint64_t operations) const;
+
+    // True if at least one event could be opened
+    bool Available() const;
+
+private:
+    static constexpr const char* Names[EventCount] = {
+        "cache_misses", "cache_refs", "branch_misses", "instructions"};
+
+    std::array<int, EventCount> mDescriptors;
+    std::array<uint64_t, EventCount> mCounts;
+};
+
+///////////////////////////////////
+/// Implementations
+
+inline PerfCounters::PerfCounters() : mCounts{}
+{
+    mDescriptors.fill(-1);
+#if defined(__linux__)
+    static constexpr uint64_t configs[EventCount] = {
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_INSTRUCTIONS};
+
+    for (uint32_t i = 0; i < EventCount; ++i)
+    {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        mDescriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+}
+
+inline PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    for (int descriptor : mDescriptors)
+    {
+        if (descriptor >= 0)
+            close(descriptor);
+    }
+#endif
+}
+
+inline void PerfCounters::Start()
+{
+#if defined(__linux__)
+    for (int descriptor : mDescriptors)
+    {
+        if (descriptor < 0)
+            continue;
+        ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+        ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+inline void PerfCounters::Stop()
+{
+#if defined(__linux__)
+    for (uint32_t i = 0; i < EventCount; ++i)
+    {
+        if (mDescriptors[i] < 0)
+            continue;
+        ioctl(mDescriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(mDescriptors[i], &mCounts[i], sizeof(uint64_t)) != sizeof(uint64_t))
+            mCounts[i] = 0;
+    }
+#endif
+}
+
+inline void PerfCounters::Report(benchmark::State& state, uint64_t operations) const
+{
+    double total = static_cast<double>(state.iterations()) * static_cast<double>(operations);
+    state.SetItemsProcessed(static_cast<int64_t>(total));
+    // Seconds per operation, printed with an SI prefix (`12.5n` is 12.5 ns/op)
+    state.counters["time_per_op"] =
+        benchmark::Counter(total, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+
+    if (total == 0)
+        return;
+    for (uint32_t i = 0; i < EventCount; ++i)
+    {
+        if (mDescriptors[i] >= 0)
+            state.counters[Names[i]] = benchmark::Counter(static_cast<double>(mCounts[i]) / total);
+    }
+}
+
+inline bool PerfCounters::Available() const
+{
+    for (int descriptor : mDescriptors)
+    {
+        if (descriptor >= 0)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,117 @@
+/**
+ * @author Will Bender
+ *
+ ** Per-frame query setup cost at 100, 1k and 10k archetypes.
+ *
+ * Archetypes hold a position, half of them a velocity, and a distinct set of tags. Each frame runs a
+ * `Query<const Position, Opt<const Velocity>>` over every table:
+ *
+ * - `FreshView` builds a new view every frame, matching every archetype and resolving its columns, the cost every
+ *   query paid before views were cached
+ * - `CachedView` keeps one view across frames, so a frame only walks the cached matches
+ *
+ * The archetypes hold no entities, so only setup is measured.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY, mZ;
+};
+
+struct Velocity
+{
+    float mX, mY, mZ;
+};
+
+template<uint32_t N>
+struct Tag
+{
+};
+
+constexpr uint32_t TagCount = 14;
+
+template<uint32_t... Is>
+std::vector<ComponentId> GetTags(std::integer_sequence<uint32_t, Is...>)
+{
+    return {MetaTypeRegistry::GetId<Tag<Is>>()...};
+}
+
+void Populate(World& world, uint32_t archetypes)
+{
+    std::vector<ComponentId> tags = GetTags(std::make_integer_sequence<uint32_t, TagCount>());
+    std::vector<ComponentId> components;
+    for (uint32_t i = 0; i < archetypes; ++i)
+    {
+        components = {MetaTypeRegistry::GetId<Position>()};
+        if (i % 2)
+            components.push_back(MetaTypeRegistry::GetId<Velocity>());
+        for (uint32_t tag = 0; tag < TagCount; ++tag)
+        {
+            if ((i >> 1) & (1u << tag))
+                components.push_back(tags[tag]);
+        }
+        std::sort(components.begin(), components.end());
+        world.GetArchetype(components);
+    }
+}
+
+using Query = View<const Position, Opt<const Velocity>>;
+
+void Frame(Query& view, uint64_t& tables)
+{
+    view.ForEachTable([&tables](uint32_t, const EntityKey*, const Position*, const Velocity*) { ++tables; });
+}
+
+void FreshView(benchmark::State& state)
+{
+    World world;
+    Populate(world, static_cast<uint32_t>(state.range(0)));
+
+    uint64_t tables = 0;
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        Query view = world.Query<const Position, Opt<const Velocity>>();
+        Frame(view, tables);
+        benchmark::DoNotOptimize(tables);
+    }
+    counters.Stop();
+    counters.Report(state, 1);
+}
+
+void CachedView(benchmark::State& state)
+{
+    World world;
+    Populate(world, static_cast<uint32_t>(state.range(0)));
+    Query view = world.Query<const Position, Opt<const Velocity>>();
+
+    uint64_t tables = 0;
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        Frame(view, tables);
+        benchmark::DoNotOptimize(tables);
+    }
+    counters.Stop();
+    counters.Report(state, 1);
+}
+
+BENCHMARK(FreshView)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(CachedView)->Arg(100)->Arg(1000)->Arg(10000);
+
+} // namespace
@@ -0,0 +1,166 @@
+/**
+ * @author Will Bender
+ *
+ ** Archetype change throughput, moving components with separate move and destruct passes against `Relocate`.
+ *
+ * Column scenarios move every value between two arrays in runs of `range(1)` values, a run of 1 being a single
+ * entity changing archetype and longer runs being batched moves. `MoveThenDestruct` is the path used before
+ * `MetaType::mRelocate` existed: `mMoveConstruct` followed by `mDestruct`, two indirect calls and two passes.
+ * `Relocate` calls `mRelocate`, and `RelocateValues` additionally copies trivially relocatable types inline.
+ *
+ * `WorldAddRemove` measures the whole archetype change through `World::Add` and `World::Remove`.
+ */
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+struct Transform
+{
+    float mX, mY, mZ, mW;
+};
+
+struct Named
+{
+    std::string mName;
+};
+
+struct Tag
+{
+};
+
+template<typename T>
+T MakeValue(uint32_t i)
+{
+    if constexpr (std::is_same_v<T, Named>)
+        return Named{"value " + std::to_string(i)};
+    else
+        return T{float(i), 0, 0, 0};
+}
+
+// Two uninitialized arrays, with values constructed in `mSrc`
+template<typename T>
+class Columns
+{
+public:
+    explicit Columns(uint32_t count) : mCount(count), mSrc(Allocate(count)), mDst(Allocate(count))
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            new (mSrc + i) T(MakeValue<T>(i));
+    }
+    Columns(const Columns& other) = delete;
+    Columns& operator=(const Columns& other) = delete;
+    ~Columns()
+    {
+        Typed<T>::Destruct(mSrc, mCount);
+        ::operator delete(mSrc, std::align_val_t(alignof(T)));
+        ::operator delete(mDst, std::align_val_t(alignof(T)));
+    }
+
+    // Swap after moving every value into `mDst`
+    void Swap() { std::swap(mSrc, mDst); }
+
+    uint32_t mCount;
+    T* mSrc;
+    T* mDst;
+
+private:
+    static T* Allocate(uint32_t count)
+    {
+        return static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t(alignof(T))));
+    }
+};
+
+// Move every value in runs, calling `move(src, dst, run)` per run
+template<typename T, typename M>
+void MoveColumns(benchmark::State& state, M&& move)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    uint32_t run = static_cast<uint32_t>(state.range(1));
+    Columns<T> columns(count);
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < count; i += run)
+            move(columns.mSrc + i, columns.mDst + i, std::min(run, count - i));
+        columns.Swap();
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, count);
+}
+
+template<typename T>
+void MoveThenDestruct(benchmark::State& state)
+{
+    const MetaType& type = MetaTypeRegistry::Get(MetaTypeRegistry::GetId<T>());
+    MoveColumns<T>(state, [&type](void* src, void* dst, uint32_t count)
+    {
+        type.mMoveConstruct(src, dst, count);
+        type.mDestruct(src, count);
+    });
+}
+
+template<typename T>
+void Relocate(benchmark::State& state)
+{
+    const MetaType& type = MetaTypeRegistry::Get(MetaTypeRegistry::GetId<T>());
+    MoveColumns<T>(state, [&type](void* src, void* dst, uint32_t count) { type.mRelocate(src, dst, count); });
+}
+
+template<typename T>
+void RelocateValues(benchmark::State& state)
+{
+    const MetaType& type = MetaTypeRegistry::Get(MetaTypeRegistry::GetId<T>());
+    MoveColumns<T>(state, [&type](void* src, void* dst, uint32_t count) { type.RelocateValues(src, dst, count); });
+}
+
+// Each entity gains and loses a tag, two archetype changes moving a trivial and a non-trivial column
+void WorldAddRemove(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    World world;
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < count; ++i)
+        entities.push_back(world.Spawn(MakeValue<Transform>(i), MakeValue<Named>(i)));
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (Entity entity : entities)
+            world.Add(entity, Tag{});
+        for (Entity entity : entities)
+            world.Remove<Tag>(entity);
+    }
+    counters.Stop();
+    counters.Report(state, uint64_t(count) * 2);
+}
+
+constexpr int64_t Count = 1 << 16;
+
+#define RELOCATE_BENCH(Kernel, Type) \
+    BENCHMARK_TEMPLATE(Kernel, Type)->ArgsProduct({{Count}, {1, 16, 256}})
+
+RELOCATE_BENCH(MoveThenDestruct, Transform);
+RELOCATE_BENCH(Relocate, Transform);
+RELOCATE_BENCH(RelocateValues, Transform);
+RELOCATE_BENCH(MoveThenDestruct, Named);
+RELOCATE_BENCH(Relocate, Named);
+RELOCATE_BENCH(RelocateValues, Named);
+
+BENCHMARK(WorldAddRemove)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMicrosecond);
+
+} // namespace
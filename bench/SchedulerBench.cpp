@@ -0,0 +1,88 @@
+/**
+ * @author Will Bender
+ *
+ ** One frame of 20 systems run by the scheduler, on 1 to N workers.
+ *
+ * Each system writes one of eight components and reads another, so systems writing different components run
+ * concurrently while the rest are ordered by the dependency graph. Tables are split into chunks across the pool.
+ * Run on a machine with several cores, the speedup is `time(1) / time(N)`.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "Scheduler.hpp"
+
+namespace
+{
+
+template<uint32_t N>
+struct Component
+{
+    float mValue[4];
+};
+
+constexpr uint32_t ComponentCount = 8;
+constexpr uint32_t SystemCount = 20;
+constexpr uint32_t EntityCount = 1 << 16;
+
+// System `I` writes component `I % 8` from component `(I + 3) % 8`
+template<uint32_t I>
+void AddSystem(Scheduler& scheduler)
+{
+    using Write = Component<I % ComponentCount>;
+    using Read = Component<(I + 3) % ComponentCount>;
+    scheduler.AddSystem<Write, const Read>("system " + std::to_string(I), [](Write& write, const Read& read)
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+            write.mValue[i] = std::sqrt(write.mValue[i] * write.mValue[i] + read.mValue[i] * 0.5f);
+    }, 4);
+}
+
+template<uint32_t... Is>
+void AddSystems(Scheduler& scheduler, std::integer_sequence<uint32_t, Is...>)
+{
+    (AddSystem<Is>(scheduler), ...);
+}
+
+template<uint32_t... Is>
+void Populate(World& world, std::integer_sequence<uint32_t, Is...>)
+{
+    for (uint32_t i = 0; i < EntityCount; ++i)
+        world.Spawn(Component<Is>{{float(i), 1, 2, 3}}...);
+}
+
+void Frame(benchmark::State& state)
+{
+    World world;
+    Populate(world, std::make_integer_sequence<uint32_t, ComponentCount>());
+
+    ThreadPool pool(static_cast<uint32_t>(state.range(0)));
+    Scheduler scheduler(pool);
+    AddSystems(scheduler, std::make_integer_sequence<uint32_t, SystemCount>());
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+        scheduler.Run(world);
+    counters.Stop();
+    counters.Report(state, uint64_t(EntityCount) * SystemCount);
+}
+
+void Workers(benchmark::internal::Benchmark* benchmark)
+{
+    uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t workers = 1; workers < hardware; workers *= 2)
+        benchmark->Arg(workers);
+    benchmark->Arg(hardware);
+}
+
+BENCHMARK(Frame)->Apply(Workers)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,342 @@
+/**
+ * @author Will Bender
+ *
+ ** SlotMap microbenchmarks against common alternatives.
+ *
+ * Every scenario runs over four containers with a small (8 byte) and a large (256 byte) value:
+ *
+ * - `SlotMap`
+ * - `std::unordered_map` keyed by an incrementing ID
+ * - `std::vector` with tombstones, keys are indices and slots are never reused
+ * - A bucket array with occupancy masks and a free list, the approach of `plf::colony`
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "Slotmap.hpp"
+
+namespace
+{
+
+struct Small
+{
+    uint64_t mValue;
+};
+
+struct Large
+{
+    uint64_t mValue;
+    uint8_t mPadding[248];
+};
+
+template<typename V>
+V MakeValue(uint64_t value)
+{
+    V out{};
+    out.mValue = value;
+    return out;
+}
+
+///////////////////////////////////
+/// Containers
+
+template<typename V>
+struct SlotMapContainer
+{
+    using Key = typename SlotMap<V>::Key;
+
+    Key Insert(const V& value) { return mMap.insert(V(value)).mKey; }
+    void Remove(Key key) { mMap.remove(key); }
+    V* Find(Key key) { return &*mMap.find(key); }
+
+    template<typename F>
+    void ForEach(F&& function)
+    {
+        for (V& value : mMap)
+            function(value);
+    }
+
+    SlotMap<V> mMap;
+};
+
+template<typename V>
+struct UnorderedMapContainer
+{
+    using Key = uint64_t;
+
+    Key Insert(const V& value)
+    {
+        mMap.emplace(mNext, value);
+        return mNext++;
+    }
+    void Remove(Key key) { mMap.erase(key); }
+    V* Find(Key key) { return &mMap.find(key)->second; }
+
+    template<typename F>
+    void ForEach(F&& function)
+    {
+        for (auto& [key, value] : mMap)
+            function(value);
+    }
+
+    std::unordered_map<uint64_t, V> mMap;
+    uint64_t mNext = 0;
+};
+
+template<typename V>
+struct TombstoneContainer
+{
+    using Key = uint32_t;
+
+    struct Slot
+    {
+        V mValue;
+        bool mAlive;
+    };
+
+    Key Insert(const V& value)
+    {
+        mSlots.push_back(Slot{value, true});
+        return static_cast<Key>(mSlots.size() - 1);
+    }
+    void Remove(Key key) { mSlots[key].mAlive = false; }
+    V* Find(Key key) { return &mSlots[key].mValue; }
+
+    template<typename F>
+    void ForEach(F&& function)
+    {
+        for (Slot& slot : mSlots)
+        {
+            if (slot.mAlive)
+                function(slot.mValue);
+        }
+    }
+
+    std::vector<Slot> mSlots;
+};
+
+template<typename V>
+struct ColonyContainer
+{
+    static constexpr uint32_t BucketSize = 64;
+
+    using Key = uint32_t;
+
+    struct Bucket
+    {
+        uint64_t mOccupied = 0;
+        alignas(V) uint8_t mValues[sizeof(V) * BucketSize];
+
+        V* At(uint32_t index) { return reinterpret_cast<V*>(mValues) + index; }
+    };
+
+    Key Insert(const V& value)
+    {
+        uint32_t index;
+        if (!mFree.empty())
+        {
+            index = mFree.back();
+            mFree.pop_back();
+        }
+        else
+        {
+            index = mCount++;
+            if (index % BucketSize == 0)
+                mBuckets.push_back(std::make_unique<Bucket>());
+        }
+
+        Bucket& bucket = *mBuckets[index / BucketSize];
+        new (bucket.At(index % BucketSize)) V(value);
+        bucket.mOccupied |= uint64_t(1) << (index % BucketSize);
+        return index;
+    }
+    void Remove(Key key)
+    {
+        Bucket& bucket = *mBuckets[key / BucketSize];
+        bucket.mOccupied &= ~(uint64_t(1) << (key % BucketSize));
+        mFree.push_back(key);
+    }
+    V* Find(Key key) { return mBuckets[key / BucketSize]->At(key % BucketSize); }
+
+    template<typename F>
+    void ForEach(F&& function)
+    {
+        // Empty buckets and runs of free slots are skipped a word at a time
+        for (const std::unique_ptr<Bucket>& bucket : mBuckets)
+        {
+            for (uint64_t mask = bucket->mOccupied; mask != 0; mask &= mask - 1)
+                function(*bucket->At(static_cast<uint32_t>(__builtin_ctzll(mask))));
+        }
+    }
+
+    std::vector<std::unique_ptr<Bucket>> mBuckets;
+    std::vector<uint32_t> mFree;
+    uint32_t mCount = 0;
+};
+
+///////////////////////////////////
+/// Scenarios
+
+template<typename C>
+using ValueOf = std::remove_reference_t<decltype(*std::declval<C&>().Find({}))>;
+
+// Fill a container with `count` values, returning their keys
+template<typename C>
+std::vector<typename C::Key> Fill(C& container, uint32_t count)
+{
+    std::vector<typename C::Key> keys;
+    keys.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+        keys.push_back(container.Insert(MakeValue<ValueOf<C>>(i)));
+    return keys;
+}
+
+template<typename C>
+void Insert(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        C container;
+        for (uint32_t i = 0; i < count; ++i)
+            benchmark::DoNotOptimize(container.Insert(MakeValue<ValueOf<C>>(i)));
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, count);
+}
+
+template<typename C>
+void Remove(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    PerfCounters counters;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        C container;
+        std::vector<typename C::Key> keys = Fill(container, count);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+        counters.Start();
+        state.ResumeTiming();
+
+        for (typename C::Key key : keys)
+            container.Remove(key);
+        benchmark::ClobberMemory();
+
+        state.PauseTiming();
+        counters.Stop();
+        state.ResumeTiming();
+    }
+    counters.Report(state, count);
+}
+
+template<typename C>
+void Find(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    C container;
+    std::vector<typename C::Key> keys = Fill(container, count);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (typename C::Key key : keys)
+            sum += container.Find(key)->mValue;
+        benchmark::DoNotOptimize(sum);
+    }
+    counters.Stop();
+    counters.Report(state, count);
+}
+
+// Iterate after removing values at random until `range(1)` percent remain
+template<typename C>
+void Iterate(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    uint32_t occupancy = static_cast<uint32_t>(state.range(1));
+
+    C container;
+    std::vector<typename C::Key> keys = Fill(container, count);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    uint32_t live = static_cast<uint32_t>(uint64_t(count) * occupancy / 100);
+    for (uint32_t i = live; i < count; ++i)
+        container.Remove(keys[i]);
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        container.ForEach([&sum](const ValueOf<C>& value) { sum += value.mValue; });
+        benchmark::DoNotOptimize(sum);
+    }
+    counters.Stop();
+    counters.Report(state, live);
+}
+
+// Steady state churn: each operation removes a random live value and inserts a new one
+template<typename C>
+void Churn(benchmark::State& state)
+{
+    uint32_t count = static_cast<uint32_t>(state.range(0));
+    C container;
+    std::vector<typename C::Key> keys = Fill(container, count);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<uint32_t> pick(0, count - 1);
+
+    constexpr uint32_t Operations = 1024;
+    uint64_t next = count;
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < Operations; ++i)
+        {
+            typename C::Key& key = keys[pick(random)];
+            container.Remove(key);
+            key = container.Insert(MakeValue<ValueOf<C>>(next++));
+        }
+        benchmark::ClobberMemory();
+    }
+    counters.Stop();
+    counters.Report(state, Operations);
+}
+
+///////////////////////////////////
+/// Registration
+
+constexpr int64_t MinCount = 1 << 10;
+constexpr int64_t MaxCount = 1 << 20;
+
+#define SLOTMAP_BENCH_VALUE(Container, Value)                                                                         \
+    BENCHMARK_TEMPLATE(Insert, Container<Value>)->RangeMultiplier(32)->Range(MinCount, MaxCount);                     \
+    BENCHMARK_TEMPLATE(Remove, Container<Value>)->RangeMultiplier(32)->Range(MinCount, MaxCount);                     \
+    BENCHMARK_TEMPLATE(Find, Container<Value>)->RangeMultiplier(32)->Range(MinCount, MaxCount);                       \
+    BENCHMARK_TEMPLATE(Iterate, Container<Value>)->ArgsProduct({{MinCount, MaxCount}, {100, 50, 10}});                \
+    BENCHMARK_TEMPLATE(Churn, Container<Value>)->RangeMultiplier(32)->Range(MinCount, MaxCount)
+
+#define SLOTMAP_BENCH(Container)                                                                                      \
+    SLOTMAP_BENCH_VALUE(Container, Small);                                                                            \
+    SLOTMAP_BENCH_VALUE(Container, Large)
+
+SLOTMAP_BENCH(SlotMapContainer);
+SLOTMAP_BENCH(UnorderedMapContainer);
+SLOTMAP_BENCH(TombstoneContainer);
+SLOTMAP_BENCH(ColonyContainer);
+
+} // namespace
@@ -0,0 +1,98 @@
+/**
+ * @author Will Bender
+ *
+ ** Save and load time of a world snapshot with 1M entities across 10 component types.
+ *
+ * Entities are spread over four archetypes of 7 to 10 components. Every component is trivially copyable, so columns
+ * are written and read with one memcpy per table. Throughput is reported in snapshot bytes per second.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "Snapshot.hpp"
+
+namespace
+{
+
+template<uint32_t N>
+struct Component
+{
+    uint32_t mA, mB;
+};
+
+constexpr uint32_t EntityCount = 1 << 20;
+
+template<uint32_t... Is>
+void Spawn(World& world, uint32_t count, std::integer_sequence<uint32_t, Is...>)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        world.Spawn(Component<Is>{i, Is}...);
+}
+
+// Every entity has components 0 to 6, and a quarter each also have 7, 7 to 8 or 7 to 9
+void Populate(World& world)
+{
+    Spawn(world, EntityCount / 4, std::make_integer_sequence<uint32_t, 7>());
+    Spawn(world, EntityCount / 4, std::make_integer_sequence<uint32_t, 8>());
+    Spawn(world, EntityCount / 4, std::make_integer_sequence<uint32_t, 9>());
+    Spawn(world, EntityCount / 4, std::make_integer_sequence<uint32_t, 10>());
+}
+
+void Save(benchmark::State& state)
+{
+    World world;
+    Populate(world);
+    std::vector<uint8_t> bytes;
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        bytes.clear();
+        WorldSnapshot::Save(world, bytes);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    counters.Stop();
+    counters.Report(state, EntityCount);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+
+void Load(benchmark::State& state)
+{
+    std::vector<uint8_t> bytes;
+    {
+        World world;
+        Populate(world);
+        WorldSnapshot::Save(world, bytes);
+    }
+
+    PerfCounters counters;
+    for (auto _ : state)
+    {
+        // Destroying the previous world is not part of loading
+        state.PauseTiming();
+        auto world = std::make_unique<World>();
+        counters.Start();
+        state.ResumeTiming();
+
+        WorldSnapshot::Load(*world, bytes);
+
+        state.PauseTiming();
+        counters.Stop();
+        world.reset();
+        state.ResumeTiming();
+    }
+    counters.Report(state, EntityCount);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+
+BENCHMARK(Save)->Unit(benchmark::kMillisecond);
+BENCHMARK(Load)->Unit(benchmark::kMillisecond);
+
+} // namespace
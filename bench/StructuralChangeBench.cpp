@@ -0,0 +1,149 @@
+/**
+ * @author Will Bender
+ *
+ ** Add/remove component throughput for 1M entities.
+ *
+ * Every entity gains and then loses a tag, either one entity at a time or through the batched `World::Add` and
+ * `World::Remove` overloads. The transition scenarios isolate finding the destination archetype: hashing the new
+ * component set, the path every structural change took before archetypes cached their edges, against one edge
+ * lookup.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY, mZ;
+};
+
+struct Velocity
+{
+    float mX, mY, mZ;
+};
+
+struct Health
+{
+    float mValue;
+};
+
+struct Tag
+{
+};
+
+constexpr uint32_t Count = 1 << 20;
+
+std::vector<Entity> Populate(World& world, uint32_t count)
+{
+    std::vector<Entity> entities;
+    entities.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+        entities.push_back(world.Spawn(Position{float(i), 0, 0}, Velocity{1, 0, 0}, Health{100}));
+    return entities;
+}
+
+void AddRemoveSingle(benchmark::State& state)
+{
+    World world;
+    std::vector<Entity> entities = Populate(world, Count);
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (Entity entity : entities)
+            world.Add(entity, Tag{});
+        for (Entity entity : entities)
+            world.Remove<Tag>(entity);
+    }
+    counters.Stop();
+    counters.Report(state, uint64_t(Count) * 2);
+}
+
+void AddRemoveBatch(benchmark::State& state)
+{
+    World world;
+    std::vector<Entity> entities = Populate(world, Count);
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        world.Add(entities, Tag{});
+        world.Remove<Tag>(entities);
+    }
+    counters.Stop();
+    counters.Report(state, uint64_t(Count) * 2);
+}
+
+// Source archetype of a single entity, with its add edge for `Tag` cached
+Archetype& PrepareTransition(World& world)
+{
+    Entity entity = world.Spawn(Position{}, Velocity{}, Health{});
+    world.Add(entity, Tag{});
+    world.Remove<Tag>(entity);
+
+    std::vector<ComponentId> components = {MetaTypeRegistry::GetId<Position>(), MetaTypeRegistry::GetId<Velocity>(),
+                                           MetaTypeRegistry::GetId<Health>()};
+    std::sort(components.begin(), components.end());
+    return world.GetArchetype(components);
+}
+
+void TransitionHashed(benchmark::State& state)
+{
+    World world;
+    Archetype& source = PrepareTransition(world);
+    ComponentId tag = MetaTypeRegistry::GetId<Tag>();
+
+    constexpr uint32_t Lookups = 1024;
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < Lookups; ++i)
+        {
+            std::vector<ComponentId> components = source.GetComponents();
+            components.insert(std::upper_bound(components.begin(), components.end(), tag), tag);
+            benchmark::DoNotOptimize(&world.GetArchetype(components));
+        }
+    }
+    counters.Stop();
+    counters.Report(state, Lookups);
+}
+
+void TransitionEdge(benchmark::State& state)
+{
+    World world;
+    Archetype& source = PrepareTransition(world);
+    ComponentId tag = MetaTypeRegistry::GetId<Tag>();
+
+    constexpr uint32_t Lookups = 1024;
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < Lookups; ++i)
+        {
+            benchmark::DoNotOptimize(tag);
+            benchmark::DoNotOptimize(&world.GetArchetype(source.GetAddEdge(tag)));
+        }
+    }
+    counters.Stop();
+    counters.Report(state, Lookups);
+}
+
+BENCHMARK(AddRemoveSingle)->Unit(benchmark::kMillisecond);
+BENCHMARK(AddRemoveBatch)->Unit(benchmark::kMillisecond);
+BENCHMARK(TransitionHashed);
+BENCHMARK(TransitionEdge);
+
+} // namespace
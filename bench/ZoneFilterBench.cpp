@@ -0,0 +1,116 @@
+/**
+ * @author Will Bender
+ *
+ ** Filtered iteration over 1M entities at 1, 5 and 10% selectivity, with and without zone maps.
+ *
+ * Entities hold a position and a health with `ZoneTraits`, and each frame sums the positions of entities whose health
+ * lies in a range. `Scan` tests every row, `ZoneMap` skips tables whose summary excludes the range. With
+ * `range(1) == 1` health grows with spawn order, so matches cluster in a few tables. With `range(1) == 0` health is
+ * shuffled, every table overlaps the range, and the zone map can only add overhead.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PerfCounters.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY, mZ;
+};
+
+struct Health
+{
+    int32_t mValue;
+};
+
+} // namespace
+
+template<>
+struct ZoneTraits<Health>
+{
+    using Summary = ZoneRange<int32_t>;
+
+    static Summary Empty() { return Summary::Empty(); }
+    static void Include(Summary& summary, const Health& health) { summary.Include(health.mValue); }
+};
+
+namespace
+{
+
+constexpr uint32_t Count = 1 << 20;
+
+void Populate(World& world, bool clustered)
+{
+    std::vector<int32_t> values(Count);
+    std::iota(values.begin(), values.end(), 0);
+    if (!clustered)
+        std::shuffle(values.begin(), values.end(), std::mt19937(1));
+    for (int32_t value : values)
+        world.Spawn(Position{float(value), 0, 0}, Health{value});
+}
+
+// Matches `selectivity` percent of the entities
+int32_t GetMax(benchmark::State& state)
+{
+    return static_cast<int32_t>(uint64_t(Count) * state.range(0) / 100) - 1;
+}
+
+void Scan(benchmark::State& state)
+{
+    World world;
+    Populate(world, state.range(1) != 0);
+    View<const Position, const Health> view = world.Query<const Position, const Health>();
+    int32_t max = GetMax(state);
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        float sum = 0;
+        view.ForEach([&sum, max](const Position& position, const Health& health)
+        {
+            if (health.mValue >= 0 && health.mValue <= max)
+                sum += position.mX;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    counters.Stop();
+    counters.Report(state, Count);
+}
+
+void ZoneMap(benchmark::State& state)
+{
+    World world;
+    Populate(world, state.range(1) != 0);
+    View<const Position, const Health> view = world.Query<const Position, const Health>();
+    int32_t max = GetMax(state);
+
+    PerfCounters counters;
+    counters.Start();
+    for (auto _ : state)
+    {
+        float sum = 0;
+        view.ForEachWhere<Health>(
+            [max](const ZoneRange<int32_t>& zone) { return zone.Overlaps(0, max); },
+            [max](const Health& health) { return health.mValue >= 0 && health.mValue <= max; },
+            [&sum](const Position& position, const Health&) { sum += position.mX; });
+        benchmark::DoNotOptimize(sum);
+    }
+    counters.Stop();
+    counters.Report(state, Count);
+}
+
+BENCHMARK(Scan)->ArgsProduct({{1, 5, 10}, {1, 0}});
+BENCHMARK(ZoneMap)->ArgsProduct({{1, 5, 10}, {1, 0}});
+
+} // namespace
@@ -0,0 +1,772 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MemoryAccounting.hpp"
+#include "MetaTypeRegistry.hpp"
+#include "Slotmap.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Archetype storage for the ECS.
+ *
+ * Archetype -> Table -> Components
+ *
+ * Each archetype stores every entity with one specific set of components. Entities are stored in tables, which hold
+ * a fixed number of rows in SoA layout. Tables are allocated in blocks to reduce allocations.
+ */
+
+///////////////////////////////////
+/// Entity Definitions
+
+using ComponentId = MetaTypeRegistry::Id;
+
+/*
+ ** Non-stable reference to an entity.
+ * Structural changes (adding/removing entities or components) may move the entity, invalidating this reference.
+ */
+struct ArchetypeEntity
+{
+    uint32_t mArchetype; // Index of the archetype within the world
+    uint32_t mTable;     // Table the entity is contained within
+    uint32_t mRow;       // Row within the table
+};
+
+// Stable entity references, Entity -> Archetype Entity -> Components
+using EntityProvider = SlotMap<ArchetypeEntity>;
+using Entity = EntityProvider::TypedKey;
+// Untyped entity key, stored in the entity column of tables
+using EntityKey = EntityProvider::Key;
+
+///////////////////////////////////
+/// Table Definitions
+
+/*
+ ** Layout shared by every table of an archetype.
+ *
+ * Columns are placed one after another within a table, each starting on a cache line. Components with `ZoneTraits`
+ * get a zone summary per table, stored after the entity column along with a validity flag per column.
+ */
+struct TableLayout
+{
+    // Target size in bytes of a single table
+    static constexpr uint32_t TargetTableSize = 16 * 1024;
+    // Alignment of every column
+    static constexpr uint32_t ColumnAlignment = 64;
+    // Zone offset of a column without a zone summary
+    static constexpr uint32_t NoZone = UINT32_MAX;
+
+    /**
+     * Compute the layout of a table
+     * @param components Sorted component IDs
+     * @return Layout
+     */
+    static TableLayout Create(const std::vector<ComponentId>& components);
+
+    std::vector<ComponentId> mComponents; // Sorted component IDs, one per column
+    std::vector<MetaType> mTypes;         // MetaType of each column
+    std::vector<uint32_t> mOffsets;       // Byte offset of each column within a table
+    std::vector<uint32_t> mZoneOffsets;   // Byte offset of each column's zone summary, or `NoZone`
+
+    uint32_t
+        mEntityOffset,    // Byte offset of the entity column
+        mZoneStateOffset, // Byte offset of the zone states, one `std::atomic<uint8_t>` per column, or `NoZone`
+        mRowCount,        // Number of rows in a table
+        mTableSize,       // Size of a table in bytes, a multiple of `mAlignment`
+        mAlignment;       // Alignment of every table, the largest of `ColumnAlignment` and each column's alignment
+};
+
+/*
+ ** Fixed size SoA storage of components.
+ *
+ * Rows [0, mCount) are always initialized, tables never contain gaps.
+ *
+ * Zone summaries contain every value of their column while valid. `Set` widens a valid summary, and archetype
+ * operations moving rows into a table invalidate it. Writes through raw column pointers must call `InvalidateZone`.
+ * Invalid summaries are rebuilt from the column on the next `GetZone`.
+ *
+ * Concurrent `GetZone` calls on one table are safe: the first caller rebuilds a stale summary while the others wait
+ * for it. Every other zone function counts as a write to its column.
+ */
+struct Table
+{
+    /**
+     * Returns the first value of a column
+     * @param column Column index, see `Archetype::GetColumn`
+     * @return Column data
+     */
+    void* GetColumn(uint32_t column) const;
+    template<typename T>
+    T* GetColumn(uint32_t column) const;
+    /**
+     * Returns a value within a column
+     * @param column Column index
+     * @param row Row index
+     * @return Value
+     */
+    void* GetValue(uint32_t column, uint32_t row) const;
+    /**
+     * Returns the entity column
+     * @return Entity keys of each row
+     */
+    EntityKey* GetEntities() const;
+
+    /**
+     * Assign a value, widening the zone summary of the column to contain it
+     * @tparam T Type stored in the column
+     * @param column Column index
+     * @param row Initialized row
+     * @param value New value
+     * @return Stored value, writes through it must invalidate the zone
+     */
+    template<typename T, typename V>
+    T& Set(uint32_t column, uint32_t row, V&& value) const;
+    /**
+     * Returns the zone summary of a column, rebuilding it if it was invalidated
+     * @param column Column index
+     * @return Summary, see `ZoneTraits`, or nullptr if the column has no zone
+     */
+    const void* GetZone(uint32_t column) const;
+    // Mark the zone summary of a column as stale, after its values were modified
+    void InvalidateZone(uint32_t column) const;
+    // Mark every zone summary as stale, after rows were moved into the table
+    void InvalidateZones() const;
+
+    uint32_t Size() const;
+    bool Full() const;
+
+    // States of a zone summary
+    enum ZoneState : uint8_t
+    {
+        ZoneInvalid,
+        ZoneBuilding,
+        ZoneValid
+    };
+    // Returns the state of a column's zone summary, the column must have one
+    std::atomic<uint8_t>& GetZoneState(uint32_t column) const;
+
+    const TableLayout* mLayout;
+    uint8_t* mData;
+    uint32_t mCount;
+};
+
+///////////////////////////////////
+/// Archetype Definitions
+
+/*
+ ** Storage for all entities with a specific set of components.
+ *
+ * Entities are kept packed: every table is full except the last one in use. Removing an entity moves the last
+ * entity of the archetype into the removed row.
+ */
+class Archetype
+{
+public:
+    // Returned when a column does not exist
+    static constexpr uint32_t InvalidColumn = UINT32_MAX;
+    // Returned when an edge has not been cached
+    static constexpr uint32_t InvalidArchetype = UINT32_MAX;
+    // Number of tables allocated at once
+    static constexpr uint32_t TablesPerBlock = 8;
+
+    /**
+     * Create an archetype
+     * @param index Index of the archetype within its world
+     * @param components Sorted, unique component IDs
+     */
+    Archetype(uint32_t index, const std::vector<ComponentId>& components);
+    Archetype(const Archetype& other) = delete;
+    Archetype& operator=(const Archetype& other) = delete;
+    ~Archetype();
+
+    /**
+     * Find the column storing a component
+     * @param component Component ID
+     * @return Column index, or `InvalidColumn`
+     */
+    uint32_t GetColumn(ComponentId component) const;
+    /**
+     * Check if all of the given sorted components are stored in this archetype
+     * @param components Sorted component IDs
+     * @return Contained
+     */
+    bool Contains(const std::vector<ComponentId>& components) const;
+
+    /**
+     * Reserve a row at the end of the archetype. Components in the row are left uninitialized.
+     * @param entity Entity stored in the row
+     * @return Location of the row
+     */
+    ArchetypeEntity Allocate(EntityKey entity);
+    /**
+     * Reserve `count` rows at the end of the archetype. Components and entity keys are left uninitialized.
+     * @param count Number of rows
+     * @return Archetype wide row index of the first reserved row
+     */
+    uint32_t AllocateTail(uint32_t count);
+    /**
+     * Remove a row, moving the last row of the archetype into its place.
+     * @param table Table of the row
+     * @param row Row within the table
+     * @param destruct Destruct the components of the row, otherwise they must already be uninitialized
+     * @return Entity moved into the row, or a default key if nothing moved
+     */
+    EntityKey Remove(uint32_t table, uint32_t row, bool destruct = true);
+    /**
+     * Swap two rows of the archetype, including their entity keys
+     * @param lhs Archetype wide row index, see `GetLocation`
+     * @param rhs Archetype wide row index
+     */
+    void SwapRows(uint32_t lhs, uint32_t rhs);
+    /**
+     * Move the last `count` rows of this archetype to the end of another archetype, in runs bounded by table
+     * boundaries. Shared components are relocated, components missing in the destination are destructed, and
+     * components missing in this archetype are left uninitialized.
+     * @param destination Archetype receiving the rows
+     * @param count Number of rows to move
+     * @return Archetype wide row index of the first moved row within the destination
+     */
+    uint32_t MoveTail(Archetype& destination, uint32_t count);
+    /**
+     * Destruct and remove the last `count` rows of this archetype, in runs bounded by table boundaries
+     * @param count Number of rows to remove
+     * @param destruct Destruct the components of the rows, otherwise they must already be uninitialized
+     */
+    void RemoveTail(uint32_t count, bool destruct = true);
+    /**
+     * Convert an archetype wide row index (rows counted across all tables) into a location
+     * @param row Archetype wide row index
+     * @return Location
+     */
+    ArchetypeEntity GetLocation(uint32_t row) const;
+
+    /**
+     * Cached archetype reached by adding a component, see `World::Add`
+     * @param component Component ID
+     * @return Archetype index, or `InvalidArchetype` if not cached
+     */
+    uint32_t GetAddEdge(ComponentId component) const;
+    void SetAddEdge(ComponentId component, uint32_t archetype);
+    /**
+     * Cached archetype reached by removing a component, see `World::Remove`
+     * @param component Component ID
+     * @return Archetype index, or `InvalidArchetype` if not cached
+     */
+    uint32_t GetRemoveEdge(ComponentId component) const;
+    void SetRemoveEdge(ComponentId component, uint32_t archetype);
+
+    uint32_t GetIndex() const;
+    const TableLayout& GetLayout() const;
+    const std::vector<ComponentId>& GetComponents() const;
+    // Number of entities
+    uint32_t Size() const;
+    // Number of tables containing entities
+    uint32_t TableCount() const;
+    Table& GetTable(uint32_t table);
+    const Table& GetTable(uint32_t table) const;
+
+private:
+    void AllocateBlock();
+    // Report column memory to `MemoryAccounting`
+    void Account();
+
+    static uint32_t GetEdge(const std::vector<uint32_t>& edges, ComponentId component);
+    static void SetEdge(std::vector<uint32_t>& edges, ComponentId component, uint32_t archetype);
+
+    uint32_t mIndex;
+    TableLayout mLayout;
+    std::vector<Table> mTables;
+    std::vector<uint8_t*> mBlocks;
+    uint32_t mSize;
+
+    // Transition edges, indexed by component ID
+    std::vector<uint32_t> mAddEdges;
+    std::vector<uint32_t> mRemoveEdges;
+    // Space for a single value of the largest column, used when swapping rows
+    uint8_t* mScratch;
+    // Memory accounts of each column followed by the entity column, empty when accounting is disabled
+    std::vector<MemoryAccount> mAccounts;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename T>
+T* Table::GetColumn(uint32_t column) const
+{
+    return static_cast<T*>(GetColumn(column));
+}
+
+template<typename T, typename V>
+T& Table::Set(uint32_t column, uint32_t row, V&& value) const
+{
+    T& out = *static_cast<T*>(GetValue(column, row));
+    out = std::forward<V>(value);
+
+    if constexpr (HasZoneTraits<T>::value)
+    {
+        uint32_t offset = mLayout->mZoneOffsets[column];
+        // Stale summaries are rebuilt from the column anyway
+        if (offset != TableLayout::NoZone && GetZoneState(column).load(std::memory_order_relaxed) == ZoneValid)
+            ZoneTraits<T>::Include(*reinterpret_cast<typename ZoneTraits<T>::Summary*>(mData + offset), out);
+    }
+    return out;
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline TableLayout TableLayout::Create(const std::vector<ComponentId>& components)
+{
+    TableLayout out{};
+    out.mComponents = components;
+
+    uint32_t rowSize = sizeof(EntityKey);
+    for (ComponentId component : components)
+    {
+        out.mTypes.push_back(MetaTypeRegistry::Get(component));
+        rowSize += out.mTypes.back().mDataSize;
+    }
+
+    out.mRowCount = std::max(1u, TargetTableSize / rowSize);
+
+    out.mAlignment = ColumnAlignment;
+    for (const MetaType& type : out.mTypes)
+        out.mAlignment = std::max(out.mAlignment, type.mDataAlignment);
+
+    auto align = [](uint32_t offset, uint32_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    };
+
+    uint32_t offset = 0;
+    for (const MetaType& type : out.mTypes)
+    {
+        offset = align(offset, std::max(type.mDataAlignment, ColumnAlignment));
+        out.mOffsets.push_back(offset);
+        offset += type.mDataSize * out.mRowCount;
+    }
+
+    out.mEntityOffset = align(offset, ColumnAlignment);
+    offset = out.mEntityOffset + static_cast<uint32_t>(sizeof(EntityKey)) * out.mRowCount;
+
+    bool zoned = false;
+    for (const MetaType& type : out.mTypes)
+    {
+        if (type.mZoneSize == 0)
+        {
+            out.mZoneOffsets.push_back(NoZone);
+            continue;
+        }
+        offset = align(offset, type.mZoneAlignment);
+        out.mZoneOffsets.push_back(offset);
+        offset += type.mZoneSize;
+        zoned = true;
+    }
+
+    out.mZoneStateOffset = zoned ? offset : NoZone;
+    if (zoned)
+    {
+        static_assert(sizeof(std::atomic<uint8_t>) == 1 && alignof(std::atomic<uint8_t>) == 1);
+        offset += static_cast<uint32_t>(out.mTypes.size());
+    }
+
+    // Tables follow each other within a block, so every table must start on the strictest column alignment
+    out.mTableSize = align(offset, out.mAlignment);
+
+    return out;
+}
+
+inline void* Table::GetColumn(uint32_t column) const
+{
+    return mData + mLayout->mOffsets[column];
+}
+
+inline void* Table::GetValue(uint32_t column, uint32_t row) const
+{
+    return mData + mLayout->mOffsets[column] + static_cast<size_t>(row) * mLayout->mTypes[column].mDataSize;
+}
+
+inline EntityKey* Table::GetEntities() const
+{
+    return reinterpret_cast<EntityKey*>(mData + mLayout->mEntityOffset);
+}
+
+inline const void* Table::GetZone(uint32_t column) const
+{
+    uint32_t offset = mLayout->mZoneOffsets[column];
+    if (offset == TableLayout::NoZone)
+        return nullptr;
+
+    std::atomic<uint8_t>& state = GetZoneState(column);
+    uint8_t current = state.load(std::memory_order_acquire);
+    while (current != ZoneValid)
+    {
+        // Claim the rebuild, readers racing for it wait until it is published
+        if (current == ZoneInvalid &&
+            state.compare_exchange_weak(current, ZoneBuilding, std::memory_order_acquire))
+        {
+            const MetaType& type = mLayout->mTypes[column];
+            type.mZoneReset(mData + offset);
+            type.mZoneInclude(mData + offset, GetColumn(column), mCount);
+            state.store(ZoneValid, std::memory_order_release);
+            break;
+        }
+        if (current == ZoneBuilding)
+            std::this_thread::yield();
+        current = state.load(std::memory_order_acquire);
+    }
+    return mData + offset;
+}
+
+inline void Table::InvalidateZone(uint32_t column) const
+{
+    if (mLayout->mZoneOffsets[column] != TableLayout::NoZone)
+        GetZoneState(column).store(ZoneInvalid, std::memory_order_relaxed);
+}
+
+inline void Table::InvalidateZones() const
+{
+    for (uint32_t column = 0; column < mLayout->mTypes.size(); ++column)
+        InvalidateZone(column);
+}
+
+inline std::atomic<uint8_t>& Table::GetZoneState(uint32_t column) const
+{
+    return reinterpret_cast<std::atomic<uint8_t>*>(mData + mLayout->mZoneStateOffset)[column];
+}
+
+inline uint32_t Table::Size() const
+{
+    return mCount;
+}
+
+inline bool Table::Full() const
+{
+    return mCount == mLayout->mRowCount;
+}
+
+inline Archetype::Archetype(uint32_t index, const std::vector<ComponentId>& components) :
+    mIndex(index), mLayout(TableLayout::Create(components)), mSize(0), mScratch(nullptr)
+{
+    if constexpr (MemoryAccounting::Enabled)
+    {
+        for (const MetaType& type : mLayout.mTypes)
+            mAccounts.push_back(MemoryAccount::For(type));
+        mAccounts.push_back(MemoryAccount::For<EntityKey>());
+    }
+}
+
+inline Archetype::~Archetype()
+{
+    for (Table& table : mTables)
+    {
+        if (table.mCount == 0)
+            continue;
+        for (uint32_t column = 0; column < mLayout.mTypes.size(); ++column)
+            mLayout.mTypes[column].DestructValues(table.GetColumn(column), table.mCount);
+    }
+
+    for (uint8_t* block : mBlocks)
+        ::operator delete(block, std::align_val_t(mLayout.mAlignment));
+    if (mScratch)
+        ::operator delete(mScratch, std::align_val_t(mLayout.mAlignment));
+}
+
+inline uint32_t Archetype::GetColumn(ComponentId component) const
+{
+    auto found = std::lower_bound(mLayout.mComponents.begin(), mLayout.mComponents.end(), component);
+    if (found == mLayout.mComponents.end() || *found != component)
+        return InvalidColumn;
+    return static_cast<uint32_t>(found - mLayout.mComponents.begin());
+}
+
+inline bool Archetype::Contains(const std::vector<ComponentId>& components) const
+{
+    return std::includes(mLayout.mComponents.begin(), mLayout.mComponents.end(),
+                         components.begin(), components.end());
+}
+
+inline ArchetypeEntity Archetype::Allocate(EntityKey entity)
+{
+    uint32_t table = mSize / mLayout.mRowCount;
+    if (table == mTables.size())
+        AllocateBlock();
+
+    Table& target = mTables[table];
+    uint32_t row = target.mCount++;
+    target.GetEntities()[row] = entity;
+    target.InvalidateZones();
+    ++mSize;
+    Account();
+
+    return ArchetypeEntity{mIndex, table, row};
+}
+
+inline uint32_t Archetype::AllocateTail(uint32_t count)
+{
+    uint32_t first = mSize;
+    while ((mSize + count + mLayout.mRowCount - 1) / mLayout.mRowCount > mTables.size())
+        AllocateBlock();
+
+    uint32_t remaining = count;
+    while (remaining != 0)
+    {
+        Table& table = mTables[mSize / mLayout.mRowCount];
+        uint32_t run = std::min(remaining, mLayout.mRowCount - table.mCount);
+        table.mCount += run;
+        table.InvalidateZones();
+        mSize += run;
+        remaining -= run;
+    }
+    Account();
+    return first;
+}
+
+inline EntityKey Archetype::Remove(uint32_t table, uint32_t row, bool destruct)
+{
+    uint32_t last = mSize - 1;
+    Table& target = mTables[table];
+    Table& source = mTables[last / mLayout.mRowCount];
+    uint32_t sourceRow = last % mLayout.mRowCount;
+    bool moves = &target != &source || row != sourceRow;
+
+    for (uint32_t column = 0; column < mLayout.mTypes.size(); ++column)
+    {
+        const MetaType& type = mLayout.mTypes[column];
+        void* dst = target.GetValue(column, row);
+        if (destruct)
+            type.DestructValues(dst, 1);
+        if (moves)
+            type.RelocateValues(source.GetValue(column, sourceRow), dst, 1);
+    }
+
+    EntityKey moved;
+    if (moves)
+    {
+        moved = source.GetEntities()[sourceRow];
+        target.GetEntities()[row] = moved;
+        // Values moved within a table are already part of its zones
+        if (&target != &source)
+            target.InvalidateZones();
+    }
+
+    --source.mCount;
+    --mSize;
+    Account();
+    return moved;
+}
+
+inline void Archetype::SwapRows(uint32_t lhs, uint32_t rhs)
+{
+    if (lhs == rhs)
+        return;
+
+    if (!mScratch)
+    {
+        uint32_t size = sizeof(EntityKey);
+        for (const MetaType& type : mLayout.mTypes)
+            size = std::max(size, type.mDataSize);
+        mScratch = static_cast<uint8_t*>(::operator new(size, std::align_val_t(mLayout.mAlignment)));
+    }
+
+    ArchetypeEntity a = GetLocation(lhs), b = GetLocation(rhs);
+    Table& tableA = mTables[a.mTable];
+    Table& tableB = mTables[b.mTable];
+    uint8_t* scratch = mScratch;
+
+    for (uint32_t column = 0; column < mLayout.mTypes.size(); ++column)
+    {
+        const MetaType& type = mLayout.mTypes[column];
+        void* valueA = tableA.GetValue(column, a.mRow);
+        void* valueB = tableB.GetValue(column, b.mRow);
+        type.RelocateValues(valueA, scratch, 1);
+        type.RelocateValues(valueB, valueA, 1);
+        type.RelocateValues(scratch, valueB, 1);
+    }
+
+    std::swap(tableA.GetEntities()[a.mRow], tableB.GetEntities()[b.mRow]);
+    if (&tableA != &tableB)
+    {
+        tableA.InvalidateZones();
+        tableB.InvalidateZones();
+    }
+}
+
+inline uint32_t Archetype::MoveTail(Archetype& destination, uint32_t count)
+{
+    if (count > mSize)
+        throw std::runtime_error("Archetype moved more rows than it contains");
+
+    // Map each source column to its destination column once, rather than per row
+    std::vector<uint32_t> columns(mLayout.mComponents.size());
+    for (uint32_t column = 0; column < columns.size(); ++column)
+        columns[column] = destination.GetColumn(mLayout.mComponents[column]);
+
+    uint32_t first = destination.AllocateTail(count);
+
+    uint32_t source = mSize - count;
+    uint32_t target = first;
+    uint32_t remaining = count;
+    while (remaining != 0)
+    {
+        ArchetypeEntity from = GetLocation(source);
+        ArchetypeEntity to = destination.GetLocation(target);
+        uint32_t run = std::min({remaining, mLayout.mRowCount - from.mRow, destination.mLayout.mRowCount - to.mRow});
+
+        Table& sourceTable = mTables[from.mTable];
+        Table& targetTable = destination.mTables[to.mTable];
+
+        for (uint32_t column = 0; column < columns.size(); ++column)
+        {
+            const MetaType& type = mLayout.mTypes[column];
+            void* value = sourceTable.GetValue(column, from.mRow);
+            if (columns[column] == InvalidColumn)
+                type.DestructValues(value, run);
+            else
+                type.RelocateValues(value, targetTable.GetValue(columns[column], to.mRow), run);
+        }
+        std::copy_n(sourceTable.GetEntities() + from.mRow, run, targetTable.GetEntities() + to.mRow);
+
+        sourceTable.mCount -= run;
+        source += run;
+        target += run;
+        remaining -= run;
+    }
+
+    mSize -= count;
+    Account();
+    return first;
+}
+
+inline void Archetype::RemoveTail(uint32_t count, bool destruct)
+{
+    if (count > mSize)
+        throw std::runtime_error("Archetype removed more rows than it contains");
+
+    uint32_t remaining = count;
+    while (remaining != 0)
+    {
+        Table& table = mTables[(mSize - 1) / mLayout.mRowCount];
+        uint32_t run = std::min(remaining, table.mCount);
+        uint32_t row = table.mCount - run;
+
+        for (uint32_t column = 0; destruct && column < mLayout.mTypes.size(); ++column)
+            mLayout.mTypes[column].DestructValues(table.GetValue(column, row), run);
+
+        table.mCount -= run;
+        mSize -= run;
+        remaining -= run;
+    }
+    Account();
+}
+
+inline ArchetypeEntity Archetype::GetLocation(uint32_t row) const
+{
+    return ArchetypeEntity{mIndex, row / mLayout.mRowCount, row % mLayout.mRowCount};
+}
+
+inline uint32_t Archetype::GetAddEdge(ComponentId component) const
+{
+    return GetEdge(mAddEdges, component);
+}
+
+inline void Archetype::SetAddEdge(ComponentId component, uint32_t archetype)
+{
+    SetEdge(mAddEdges, component, archetype);
+}
+
+inline uint32_t Archetype::GetRemoveEdge(ComponentId component) const
+{
+    return GetEdge(mRemoveEdges, component);
+}
+
+inline void Archetype::SetRemoveEdge(ComponentId component, uint32_t archetype)
+{
+    SetEdge(mRemoveEdges, component, archetype);
+}
+
+inline uint32_t Archetype::GetEdge(const std::vector<uint32_t>& edges, ComponentId component)
+{
+    return component < edges.size() ? edges[component] : InvalidArchetype;
+}
+
+inline void Archetype::SetEdge(std::vector<uint32_t>& edges, ComponentId component, uint32_t archetype)
+{
+    if (component >= edges.size())
+        edges.resize(component + 1, InvalidArchetype);
+    edges[component] = archetype;
+}
+
+inline uint32_t Archetype::GetIndex() const
+{
+    return mIndex;
+}
+
+inline const TableLayout& Archetype::GetLayout() const
+{
+    return mLayout;
+}
+
+inline const std::vector<ComponentId>& Archetype::GetComponents() const
+{
+    return mLayout.mComponents;
+}
+
+inline uint32_t Archetype::Size() const
+{
+    return mSize;
+}
+
+inline uint32_t Archetype::TableCount() const
+{
+    return (mSize + mLayout.mRowCount - 1) / mLayout.mRowCount;
+}
+
+inline Table& Archetype::GetTable(uint32_t table)
+{
+    return mTables[table];
+}
+
+inline const Table& Archetype::GetTable(uint32_t table) const
+{
+    return mTables[table];
+}
+
+inline void Archetype::AllocateBlock()
+{
+    uint8_t* block = static_cast<uint8_t*>(::operator new(
+        static_cast<size_t>(mLayout.mTableSize) * TablesPerBlock, std::align_val_t(mLayout.mAlignment)));
+    mBlocks.push_back(block);
+
+    for (uint32_t i = 0; i < TablesPerBlock; ++i)
+    {
+        mTables.push_back(Table{&mLayout, block + static_cast<size_t>(mLayout.mTableSize) * i, 0});
+        if (mLayout.mZoneStateOffset != TableLayout::NoZone)
+        {
+            for (uint32_t column = 0; column < mLayout.mTypes.size(); ++column)
+                new (mTables.back().mData + mLayout.mZoneStateOffset + column) std::atomic<uint8_t>(Table::ZoneInvalid);
+        }
+    }
+}
+
+inline void Archetype::Account()
+{
+    if constexpr (MemoryAccounting::Enabled)
+    {
+        size_t capacity = mTables.size() * static_cast<size_t>(mLayout.mRowCount);
+        for (uint32_t column = 0; column < mLayout.mTypes.size(); ++column)
+        {
+            size_t size = mLayout.mTypes[column].mDataSize;
+            mAccounts[column].Update(mSize * size, capacity * size);
+        }
+        mAccounts.back().Update(mSize * sizeof(EntityKey), capacity * sizeof(EntityKey));
+    }
+}
@@ -0,0 +1,460 @@
+#pragma once
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "MemoryAccounting.hpp"
+#include "MetaType.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Type-erased vector driven by a `MetaType`.
+ */
+
+/*
+ ** Contiguous, aligned array of values whose type is only known at runtime.
+ *
+ * Memory is allocated with the alignment of the type, or a larger alignment requested at construction (for
+ * example a cache line or SIMD register width). All construction, destruction and growth goes through the
+ * lifecycle pointers of the `MetaType`, which must all be set.
+ *
+ * Used as the storage for SoA component columns. Memory is reported to `MemoryAccounting` under the stored type.
+ */
+class BlobVector
+{
+public:
+    // Alignment of a cache line
+    static constexpr uint32_t CacheLineAlignment = 64;
+    // Alignment of the widest common SIMD registers (AVX-512)
+    static constexpr uint32_t SimdAlignment = 64;
+
+    /**
+     * Create an empty `BlobVector`
+     * @param type Type stored within the vector
+     * @param alignment Minimum alignment of the buffer, must be a power of two. Never lower than the type's alignment.
+     */
+    explicit BlobVector(const MetaType& type, uint32_t alignment = 0);
+    BlobVector(const BlobVector& other);
+    BlobVector(BlobVector&& other) noexcept;
+    BlobVector& operator=(const BlobVector& other);
+    BlobVector& operator=(BlobVector&& other) noexcept;
+    ~BlobVector();
+
+    /**
+     * Ensure space for `capacity` values without reallocation
+     * @param capacity Minimum capacity
+     */
+    void Reserve(uint32_t capacity);
+    /**
+     * Default construct or destruct values until the vector contains `size` values
+     * @param size New size
+     */
+    void Resize(uint32_t size);
+    /**
+     * Destruct all values, keeping the allocation
+     */
+    void Clear();
+    /**
+     * Reallocate so the capacity matches the size
+     */
+    void ShrinkToFit();
+
+    /**
+     * Default construct values at the end of the vector
+     * @param count Number of values
+     * @return Pointer to the first constructed value
+     */
+    void* PushBack(uint32_t count = 1);
+    /**
+     * Copy construct values at the end of the vector
+     * @param src Array of `count` initialized values
+     * @param count Number of values
+     */
+    void PushBackCopy(const void* src, uint32_t count = 1);
+    /**
+     * Move construct values at the end of the vector, the source values stay initialized
+     * @param src Array of `count` initialized values
+     * @param count Number of values
+     */
+    void PushBackMove(void* src, uint32_t count = 1);
+    /**
+     * Relocate values to the end of the vector, the source values are left uninitialized
+     * @param src Array of `count` initialized values
+     * @param count Number of values
+     */
+    void PushBackRelocate(void* src, uint32_t count = 1);
+    /**
+     * Copy construct values at the end of the vector from an interleaved array, such as one field of an array of
+     * structs
+     * @param src First source value
+     * @param stride Bytes between source values, 0 repeats a single value
+     * @param count Number of values
+     */
+    void PushBackStrided(const void* src, size_t stride, uint32_t count);
+    /**
+     * Copy construct values at the end of the vector from selected values of an array
+     * @param src Array of values
+     * @param indices Index of each value to copy within `src`
+     * @param count Number of indices
+     */
+    void PushBackGather(const void* src, const uint32_t* indices, uint32_t count);
+    /**
+     * Destruct values at the end of the vector
+     * @param count Number of values
+     */
+    void PopBack(uint32_t count = 1);
+
+    /**
+     * Remove values, preserving the order of the remaining values
+     * @param index First value to remove
+     * @param count Number of values
+     */
+    void Erase(uint32_t index, uint32_t count = 1);
+    /**
+     * Remove values, filling the gap with values from the end of the vector. Does not preserve order.
+     * @param index First value to remove
+     * @param count Number of values
+     */
+    void SwapRemove(uint32_t index, uint32_t count = 1);
+
+    void* Data();
+    const void* Data() const;
+    void* At(uint32_t index);
+    const void* At(uint32_t index) const;
+
+    template<typename T>
+    T* Data();
+    template<typename T>
+    const T* Data() const;
+
+    uint32_t Size() const;
+    uint32_t Capacity() const;
+    bool Empty() const;
+    uint32_t GetAlignment() const;
+    const MetaType& GetType() const;
+
+private:
+    uint8_t* Allocate(uint32_t capacity) const;
+    void Deallocate(uint8_t* data) const;
+    void Reallocate(uint32_t capacity);
+    template<typename Construct>
+    void Append(uint32_t count, Construct&& construct);
+    uint8_t* Offset(uint32_t index) const;
+    void Account();
+
+    MetaType mType;
+    uint8_t* mData;
+    uint32_t mSize;
+    uint32_t mCapacity;
+    uint32_t mAlignment;
+    MemoryAccount mAccount;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename T>
+T* BlobVector::Data()
+{
+    return static_cast<T*>(Data());
+}
+
+template<typename T>
+const T* BlobVector::Data() const
+{
+    return static_cast<const T*>(Data());
+}
+
+// Constructs `count` values at the end with `construct(dst)`. When growing, the values are constructed in the new
+// buffer before the old one is released, so sources pointing into this vector stay valid.
+template<typename Construct>
+void BlobVector::Append(uint32_t count, Construct&& construct)
+{
+    uint32_t required = mSize + count;
+    if (required <= mCapacity)
+    {
+        construct(Offset(mSize));
+    }
+    else
+    {
+        uint32_t capacity = std::max(required, std::max(mCapacity * 2, 8u));
+        uint8_t* data = Allocate(capacity);
+        try
+        {
+            construct(data + static_cast<size_t>(mSize) * mType.mDataSize);
+        }
+        catch (...)
+        {
+            Deallocate(data);
+            throw;
+        }
+        if (mSize != 0)
+            mType.RelocateValues(mData, data, mSize);
+        Deallocate(mData);
+
+        mData = data;
+        mCapacity = capacity;
+    }
+    mSize += count;
+    Account();
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline BlobVector::BlobVector(const MetaType& type, uint32_t alignment) :
+    mType(type), mData(nullptr), mSize(0), mCapacity(0), mAlignment(std::max(type.mDataAlignment, alignment)),
+    mAccount(MemoryAccount::For(type))
+{
+    if (mAlignment == 0 || (mAlignment & (mAlignment - 1)) != 0)
+        throw std::runtime_error("BlobVector alignment must be a power of two");
+}
+
+inline BlobVector::BlobVector(const BlobVector& other) :
+    mType(other.mType), mData(nullptr), mSize(0), mCapacity(0), mAlignment(other.mAlignment),
+    mAccount(other.mAccount)
+{
+    PushBackCopy(other.mData, other.mSize);
+}
+
+inline BlobVector::BlobVector(BlobVector&& other) noexcept :
+    mType(other.mType), mData(other.mData), mSize(other.mSize), mCapacity(other.mCapacity),
+    mAlignment(other.mAlignment), mAccount(std::move(other.mAccount))
+{
+    other.mData = nullptr;
+    other.mSize = 0;
+    other.mCapacity = 0;
+}
+
+inline BlobVector& BlobVector::operator=(const BlobVector& other)
+{
+    if (this != &other)
+    {
+        BlobVector copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+inline BlobVector& BlobVector::operator=(BlobVector&& other) noexcept
+{
+    if (this != &other)
+    {
+        Clear();
+        Deallocate(mData);
+
+        mType = other.mType;
+        mData = other.mData;
+        mSize = other.mSize;
+        mCapacity = other.mCapacity;
+        mAlignment = other.mAlignment;
+        mAccount = std::move(other.mAccount);
+
+        other.mData = nullptr;
+        other.mSize = 0;
+        other.mCapacity = 0;
+    }
+    return *this;
+}
+
+inline BlobVector::~BlobVector()
+{
+    Clear();
+    Deallocate(mData);
+}
+
+inline void BlobVector::Reserve(uint32_t capacity)
+{
+    if (capacity > mCapacity)
+        Reallocate(capacity);
+}
+
+inline void BlobVector::Resize(uint32_t size)
+{
+    if (size > mSize)
+        PushBack(size - mSize);
+    else if (size < mSize)
+        PopBack(mSize - size);
+}
+
+inline void BlobVector::Clear()
+{
+    PopBack(mSize);
+}
+
+inline void BlobVector::ShrinkToFit()
+{
+    if (mCapacity != mSize)
+        Reallocate(mSize);
+}
+
+inline void* BlobVector::PushBack(uint32_t count)
+{
+    Append(count, [&](uint8_t* dst) { mType.mDefaultConstruct(dst, count); });
+    return Offset(mSize - count);
+}
+
+inline void BlobVector::PushBackCopy(const void* src, uint32_t count)
+{
+    if (count == 0)
+        return;
+    Append(count, [&](uint8_t* dst) { mType.mCopyConstruct(const_cast<void*>(src), dst, count); });
+}
+
+inline void BlobVector::PushBackMove(void* src, uint32_t count)
+{
+    if (count == 0)
+        return;
+    Append(count, [&](uint8_t* dst) { mType.mMoveConstruct(src, dst, count); });
+}
+
+inline void BlobVector::PushBackRelocate(void* src, uint32_t count)
+{
+    if (count == 0)
+        return;
+    Append(count, [&](uint8_t* dst) { mType.RelocateValues(src, dst, count); });
+}
+
+inline void BlobVector::PushBackStrided(const void* src, size_t stride, uint32_t count)
+{
+    if (count == 0)
+        return;
+    Append(count, [&](uint8_t* dst) { mType.mCopyConstructStrided(src, stride, dst, mType.mDataSize, count); });
+}
+
+inline void BlobVector::PushBackGather(const void* src, const uint32_t* indices, uint32_t count)
+{
+    if (count == 0)
+        return;
+    Append(count, [&](uint8_t* dst) { mType.mGather(src, indices, dst, count); });
+}
+
+inline void BlobVector::PopBack(uint32_t count)
+{
+    if (count > mSize)
+        throw std::runtime_error("BlobVector popped more values than it contains");
+    if (count == 0)
+        return;
+
+    mSize -= count;
+    mType.DestructValues(Offset(mSize), count);
+    Account();
+}
+
+inline void BlobVector::Erase(uint32_t index, uint32_t count)
+{
+    if (index > mSize || count > mSize - index)
+        throw std::runtime_error("BlobVector erased out of range");
+    if (count == 0)
+        return;
+
+    mType.DestructValues(Offset(index), count);
+
+    // Shift the tail down in chunks no larger than the gap, so source and destination never overlap
+    uint32_t dst = index;
+    for (uint32_t src = index + count; src < mSize; src += count, dst += count)
+        mType.RelocateValues(Offset(src), Offset(dst), std::min(count, mSize - src));
+
+    mSize -= count;
+    Account();
+}
+
+inline void BlobVector::SwapRemove(uint32_t index, uint32_t count)
+{
+    if (index > mSize || count > mSize - index)
+        throw std::runtime_error("BlobVector removed out of range");
+    if (count == 0)
+        return;
+
+    mType.DestructValues(Offset(index), count);
+
+    uint32_t moved = std::min(count, mSize - (index + count));
+    if (moved != 0)
+        mType.RelocateValues(Offset(mSize - moved), Offset(index), moved);
+
+    mSize -= count;
+    Account();
+}
+
+inline void* BlobVector::Data()
+{
+    return mData;
+}
+
+inline const void* BlobVector::Data() const
+{
+    return mData;
+}
+
+inline void* BlobVector::At(uint32_t index)
+{
+    return Offset(index);
+}
+
+inline const void* BlobVector::At(uint32_t index) const
+{
+    return Offset(index);
+}
+
+inline uint32_t BlobVector::Size() const
+{
+    return mSize;
+}
+
+inline uint32_t BlobVector::Capacity() const
+{
+    return mCapacity;
+}
+
+inline bool BlobVector::Empty() const
+{
+    return mSize == 0;
+}
+
+inline uint32_t BlobVector::GetAlignment() const
+{
+    return mAlignment;
+}
+
+inline const MetaType& BlobVector::GetType() const
+{
+    return mType;
+}
+
+inline uint8_t* BlobVector::Allocate(uint32_t capacity) const
+{
+    if (capacity == 0)
+        return nullptr;
+    return static_cast<uint8_t*>(
+        ::operator new(static_cast<size_t>(capacity) * mType.mDataSize, std::align_val_t(mAlignment)));
+}
+
+inline void BlobVector::Deallocate(uint8_t* data) const
+{
+    if (data)
+        ::operator delete(data, std::align_val_t(mAlignment));
+}
+
+inline void BlobVector::Reallocate(uint32_t capacity)
+{
+    uint8_t* data = Allocate(capacity);
+    if (mSize != 0)
+        mType.RelocateValues(mData, data, mSize);
+    Deallocate(mData);
+
+    mData = data;
+    mCapacity = capacity;
+    Account();
+}
+
+inline uint8_t* BlobVector::Offset(uint32_t index) const
+{
+    return mData + static_cast<size_t>(index) * mType.mDataSize;
+}
+
+inline void BlobVector::Account()
+{
+    mAccount.Update(static_cast<size_t>(mSize) * mType.mDataSize, static_cast<size_t>(mCapacity) * mType.mDataSize);
+}
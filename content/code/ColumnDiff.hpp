@@ -0,0 +1,383 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Archetype.hpp"
+#include "BlobVector.hpp"
+#include "MetaType.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Delta compression of type-erased columns.
+ *
+ * A delta lists the runs of values that differ between two versions of a column, along with the new values written
+ * through `MetaType::mSerialize`. Columns are compared a block at a time with one bulk `MetaType::mEquals` call, so
+ * unchanged blocks cost a single memcmp for trivially comparable types, and only changed blocks are narrowed down
+ * value by value.
+ *
+ * Tables are diffed against a copy captured with `ColumnDiff::Capture`. Whole `SlotMap`s and worlds are diffed as
+ * serialized images, see `SlotMap::Serialize` and `WorldSnapshot::Save`.
+ */
+
+/*
+ ** Changes between two versions of a column.
+ */
+struct ColumnDelta
+{
+    struct Run
+    {
+        uint32_t mStart;
+        uint32_t mCount;
+    };
+
+    // Number of values in the new column
+    uint32_t mCount = 0;
+    // Sorted, non adjacent runs of changed values
+    std::vector<Run> mRuns;
+    // Serialized values of every run, in run order
+    std::vector<uint8_t> mData;
+
+    // Check if the delta changes nothing, given the previous size
+    bool Empty(uint32_t previousCount) const;
+};
+
+/*
+ ** Computes and applies column deltas.
+ */
+class ColumnDiff
+{
+public:
+    // Values compared per bulk `mEquals` call before narrowing down to single values
+    static constexpr uint32_t BlockSize = 64;
+
+    /**
+     * Compute the changes from one column to another
+     * @param type Type of both columns, must have comparison and serialization hooks
+     * @param previous Previous values
+     * @param previousCount Number of previous values
+     * @param next New values
+     * @param nextCount Number of new values
+     * @return Delta, appending values past the previous size as one run
+     */
+    static ColumnDelta Diff(const MetaType& type, const void* previous, uint32_t previousCount, const void* next,
+                            uint32_t nextCount);
+    static ColumnDelta Diff(const BlobVector& previous, const BlobVector& next);
+    /**
+     * Apply a delta to a column holding the previous values. Malformed runs are rejected before the column changes.
+     * If the values fail to deserialize, the runs applied so far are kept and every value stays initialized.
+     * @param column Column to update, resized to the size of the delta. Its type must be move constructible.
+     * @param delta Delta computed against the current values of the column
+     */
+    static void Apply(BlobVector& column, const ColumnDelta& delta);
+
+    /**
+     * Copy every column of a table, to diff it later on
+     * @param table Table to copy
+     * @return Component columns followed by the entity column
+     */
+    static std::vector<BlobVector> Capture(const Table& table);
+    /**
+     * Compute the changes of a table since it was captured
+     * @param previous Columns returned by `Capture` on a table with the same layout
+     * @param next Current table
+     * @return Delta of each column of `previous`
+     */
+    static std::vector<ColumnDelta> Diff(const std::vector<BlobVector>& previous, const Table& next);
+    /**
+     * Apply table deltas to captured columns
+     * @param columns Columns returned by `Capture`
+     * @param deltas Deltas computed against `columns`
+     */
+    static void Apply(std::vector<BlobVector>& columns, const std::vector<ColumnDelta>& deltas);
+
+    /**
+     * Compute the changes between two serialized images, such as `SlotMap::Serialize` or `WorldSnapshot::Save`
+     * output. Images are compared 64 bytes at a time.
+     * @param previous Previous image
+     * @param next New image
+     * @return Delta of the bytes
+     */
+    static ColumnDelta DiffImages(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& next);
+    /**
+     * Apply a delta to a serialized image
+     * @param image Image to update
+     * @param delta Delta computed against `image`
+     */
+    static void ApplyImage(std::vector<uint8_t>& image, const ColumnDelta& delta);
+
+    /**
+     * Hash fixed size blocks of a column, to detect changed blocks without keeping a copy of the column
+     * @param type Type of the column, must have a hash hook
+     * @param column Values
+     * @param count Number of values
+     * @return Hash of each block of `BlockSize` values
+     */
+    static std::vector<uint64_t> BlockHashes(const MetaType& type, const void* column, uint32_t count);
+
+    /**
+     * Append a delta to a byte buffer
+     * @param delta Delta to write
+     * @param out Buffer to append to
+     */
+    static void Serialize(const ColumnDelta& delta, std::vector<uint8_t>& out);
+    /**
+     * Read a delta written by `Serialize`, throwing on malformed input
+     * @param in Start of the delta
+     * @param end End of the input
+     * @param delta Delta to read into
+     * @return End of the delta
+     */
+    static const uint8_t* Deserialize(const uint8_t* in, const uint8_t* end, ColumnDelta& delta);
+
+private:
+    static void AddRun(ColumnDelta& delta, uint32_t start, uint32_t count);
+    static void Require(const uint8_t* in, const uint8_t* end, size_t size);
+};
+
+///////////////////////////////////
+/// Implementations
+
+inline bool ColumnDelta::Empty(uint32_t previousCount) const
+{
+    return mRuns.empty() && mCount == previousCount;
+}
+
+inline ColumnDelta ColumnDiff::Diff(const MetaType& type, const void* previous, uint32_t previousCount,
+                                    const void* next, uint32_t nextCount)
+{
+    if (!type.mEquals || !type.mSerialize)
+        throw std::runtime_error("Type " + std::string(type.mName) + " can not be diffed");
+
+    const uint8_t* lhs = static_cast<const uint8_t*>(previous);
+    const uint8_t* rhs = static_cast<const uint8_t*>(next);
+    size_t size = type.mDataSize;
+
+    ColumnDelta out;
+    out.mCount = nextCount;
+
+    uint32_t common = std::min(previousCount, nextCount);
+    for (uint32_t block = 0; block < common; block += BlockSize)
+    {
+        uint32_t count = std::min(BlockSize, common - block);
+        if (type.mEquals(lhs + block * size, rhs + block * size, count))
+            continue;
+
+        for (uint32_t i = block; i < block + count; ++i)
+        {
+            if (!type.mEquals(lhs + i * size, rhs + i * size, 1))
+                AddRun(out, i, 1);
+        }
+    }
+    if (nextCount > previousCount)
+        AddRun(out, previousCount, nextCount - previousCount);
+
+    for (const ColumnDelta::Run& run : out.mRuns)
+        type.mSerialize(rhs + run.mStart * size, run.mCount, out.mData);
+    return out;
+}
+
+inline ColumnDelta ColumnDiff::Diff(const BlobVector& previous, const BlobVector& next)
+{
+    return Diff(next.GetType(), previous.Data(), previous.Size(), next.Data(), next.Size());
+}
+
+inline void ColumnDiff::Apply(BlobVector& column, const ColumnDelta& delta)
+{
+    const MetaType& type = column.GetType();
+    if (!type.mDeserialize)
+        throw std::runtime_error("Type " + std::string(type.mName) + " has no serialization hooks");
+
+    // Runs are checked before the column changes. Values past the current size can only be appended, so each of them
+    // must be part of a run.
+    uint32_t size = std::min(column.Size(), delta.mCount);
+    uint32_t covered = 0;
+    uint32_t largest = 0;
+    for (const ColumnDelta::Run& run : delta.mRuns)
+    {
+        if (run.mStart > delta.mCount || run.mCount > delta.mCount - run.mStart)
+            throw std::runtime_error("Invalid delta - run out of range");
+        if (run.mStart < covered)
+            throw std::runtime_error("Invalid delta - runs overlap");
+        if (run.mStart > std::max(covered, size))
+            throw std::runtime_error("Invalid delta - appended values missing");
+        covered = run.mStart + run.mCount;
+        largest = std::max(largest, run.mCount);
+    }
+    if (std::max(covered, size) < delta.mCount)
+        throw std::runtime_error("Invalid delta - appended values missing");
+
+    if (column.Size() > delta.mCount)
+        column.PopBack(column.Size() - delta.mCount);
+    // Appending never reallocates, so values relocated out of the scratch memory can not be lost
+    column.Reserve(delta.mCount);
+    if (largest == 0)
+        return;
+
+    // Values are deserialized into scratch memory, then moved over the old values or appended. A throw leaves every
+    // value of the column initialized, with the runs applied so far. Trivial types deserialize a whole run at once,
+    // others one value at a time so a throw never leaves a partially constructed run.
+    bool trivial = type.mTriviallyRelocatable && type.mTriviallyDestructible;
+    uint32_t batch = trivial ? largest : 1;
+    auto release = [&type](void* data) { ::operator delete(data, std::align_val_t(type.mDataAlignment)); };
+    std::unique_ptr<void, decltype(release)> scratch(
+        ::operator new(static_cast<size_t>(batch) * type.mDataSize, std::align_val_t(type.mDataAlignment)), release);
+    uint8_t* values = static_cast<uint8_t*>(scratch.get());
+
+    const uint8_t* in = delta.mData.data();
+    const uint8_t* end = in + delta.mData.size();
+    for (const ColumnDelta::Run& run : delta.mRuns)
+    {
+        for (uint32_t offset = 0; offset < run.mCount; offset += batch)
+        {
+            uint32_t index = run.mStart + offset;
+            uint32_t count = std::min(batch, run.mCount - offset);
+            in = type.mDeserialize(in, end, values, count);
+
+            uint32_t replaced = index < size ? std::min(count, size - index) : 0;
+            if (replaced != 0)
+            {
+                type.DestructValues(column.At(index), replaced);
+                type.RelocateValues(values, column.At(index), replaced);
+            }
+            if (count != replaced)
+                column.PushBackRelocate(values + static_cast<size_t>(replaced) * type.mDataSize, count - replaced);
+        }
+    }
+}
+
+inline std::vector<BlobVector> ColumnDiff::Capture(const Table& table)
+{
+    const TableLayout& layout = *table.mLayout;
+
+    std::vector<BlobVector> out;
+    out.reserve(layout.mTypes.size() + 1);
+    for (uint32_t column = 0; column < layout.mTypes.size(); ++column)
+    {
+        BlobVector& copy = out.emplace_back(layout.mTypes[column]);
+        copy.PushBackCopy(table.GetColumn(column), table.mCount);
+    }
+
+    BlobVector& entities = out.emplace_back(MetaType::GenerateType<EntityKey>());
+    entities.PushBackCopy(table.GetEntities(), table.mCount);
+    return out;
+}
+
+inline std::vector<ColumnDelta> ColumnDiff::Diff(const std::vector<BlobVector>& previous, const Table& next)
+{
+    const TableLayout& layout = *next.mLayout;
+    if (previous.size() != layout.mTypes.size() + 1)
+        throw std::runtime_error("Captured table has a different layout");
+
+    std::vector<ColumnDelta> out;
+    out.reserve(previous.size());
+    for (uint32_t column = 0; column < layout.mTypes.size(); ++column)
+    {
+        const BlobVector& copy = previous[column];
+        out.push_back(Diff(layout.mTypes[column], copy.Data(), copy.Size(), next.GetColumn(column), next.mCount));
+    }
+
+    const BlobVector& entities = previous.back();
+    out.push_back(Diff(entities.GetType(), entities.Data(), entities.Size(), next.GetEntities(), next.mCount));
+    return out;
+}
+
+inline void ColumnDiff::Apply(std::vector<BlobVector>& columns, const std::vector<ColumnDelta>& deltas)
+{
+    if (columns.size() != deltas.size())
+        throw std::runtime_error("Invalid delta - column count mismatch");
+
+    for (size_t i = 0; i < columns.size(); ++i)
+        Apply(columns[i], deltas[i]);
+}
+
+inline ColumnDelta ColumnDiff::DiffImages(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& next)
+{
+    if (previous.size() > UINT32_MAX || next.size() > UINT32_MAX)
+        throw std::runtime_error("Image too large to diff");
+
+    static const MetaType bytes = MetaType::GenerateType<uint8_t>();
+    return Diff(bytes, previous.data(), static_cast<uint32_t>(previous.size()), next.data(),
+                static_cast<uint32_t>(next.size()));
+}
+
+inline void ColumnDiff::ApplyImage(std::vector<uint8_t>& image, const ColumnDelta& delta)
+{
+    image.resize(delta.mCount);
+
+    const uint8_t* in = delta.mData.data();
+    const uint8_t* end = in + delta.mData.size();
+    for (const ColumnDelta::Run& run : delta.mRuns)
+    {
+        if (run.mStart > delta.mCount || run.mCount > delta.mCount - run.mStart)
+            throw std::runtime_error("Invalid delta - run out of range");
+        Require(in, end, run.mCount);
+        std::memcpy(image.data() + run.mStart, in, run.mCount);
+        in += run.mCount;
+    }
+}
+
+inline std::vector<uint64_t> ColumnDiff::BlockHashes(const MetaType& type, const void* column, uint32_t count)
+{
+    if (!type.mHash)
+        throw std::runtime_error("Type " + std::string(type.mName) + " can not be hashed");
+
+    const uint8_t* data = static_cast<const uint8_t*>(column);
+    std::vector<uint64_t> out;
+    out.reserve((count + BlockSize - 1) / BlockSize);
+    for (uint32_t block = 0; block < count; block += BlockSize)
+        out.push_back(type.mHash(data + block * type.mDataSize, std::min(BlockSize, count - block), 0));
+    return out;
+}
+
+inline void ColumnDiff::Serialize(const ColumnDelta& delta, std::vector<uint8_t>& out)
+{
+    uint32_t header[3] = {delta.mCount, static_cast<uint32_t>(delta.mRuns.size()),
+                          static_cast<uint32_t>(delta.mData.size())};
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(header);
+    out.insert(out.end(), bytes, bytes + sizeof(header));
+
+    bytes = reinterpret_cast<const uint8_t*>(delta.mRuns.data());
+    out.insert(out.end(), bytes, bytes + sizeof(ColumnDelta::Run) * delta.mRuns.size());
+    out.insert(out.end(), delta.mData.begin(), delta.mData.end());
+}
+
+inline const uint8_t* ColumnDiff::Deserialize(const uint8_t* in, const uint8_t* end, ColumnDelta& delta)
+{
+    uint32_t header[3];
+    Require(in, end, sizeof(header));
+    std::memcpy(header, in, sizeof(header));
+    in += sizeof(header);
+
+    delta.mCount = header[0];
+
+    size_t runs = sizeof(ColumnDelta::Run) * static_cast<size_t>(header[1]);
+    Require(in, end, runs);
+    delta.mRuns.resize(header[1]);
+    std::memcpy(delta.mRuns.data(), in, runs);
+    in += runs;
+
+    Require(in, end, header[2]);
+    delta.mData.assign(in, in + header[2]);
+    return in + header[2];
+}
+
+inline void ColumnDiff::AddRun(ColumnDelta& delta, uint32_t start, uint32_t count)
+{
+    if (!delta.mRuns.empty() && delta.mRuns.back().mStart + delta.mRuns.back().mCount == start)
+        delta.mRuns.back().mCount += count;
+    else
+        delta.mRuns.push_back({start, count});
+}
+
+inline void ColumnDiff::Require(const uint8_t* in, const uint8_t* end, size_t size)
+{
+    if (static_cast<size_t>(end - in) < size)
+        throw std::runtime_error("Invalid delta - unexpected end of data");
+}
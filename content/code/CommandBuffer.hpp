@@ -0,0 +1,582 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "World.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Deferred structural changes.
+ *
+ * Spawning, despawning, and adding or removing components mutate the entity provider and archetype tables, so they
+ * can not happen while systems iterate in parallel. Instead, commands are recorded into per-thread buffers and
+ * applied together at a sync point.
+ */
+
+// True if no type appears more than once in `Ts`
+template<typename... Ts>
+struct UniqueTypes : std::true_type {};
+
+template<typename T, typename... Ts>
+struct UniqueTypes<T, Ts...> : std::bool_constant<!(std::is_same_v<T, Ts> || ...) && UniqueTypes<Ts...>::value> {};
+
+/*
+ ** Records structural commands into an arena.
+ *
+ * Commands and their component payloads are written sequentially into large blocks, which are reused after the
+ * buffer is cleared. Payloads are constructed in place, and relocated into tables when applied.
+ *
+ * A single buffer is not thread safe, use `CommandQueue::Local` to get one buffer per thread.
+ */
+class CommandBuffer
+{
+public:
+    // Size of a single arena block in bytes
+    static constexpr uint32_t BlockSize = 64 * 1024;
+    // Alignment of arena blocks
+    static constexpr uint32_t BlockAlignment = 64;
+
+    CommandBuffer();
+    CommandBuffer(const CommandBuffer& other) = delete;
+    CommandBuffer& operator=(const CommandBuffer& other) = delete;
+    ~CommandBuffer();
+
+    /**
+     * Record the creation of an entity
+     * @param components Components, each type may appear once (checked at compile time)
+     */
+    template<typename... Ts>
+    void Spawn(Ts&&... components);
+    /**
+     * Record the destruction of an entity
+     * @param entity Entity to destroy
+     */
+    void Despawn(Entity entity);
+    /**
+     * Record adding a component to an entity, replacing it if the entity already has one
+     * @param entity Entity to modify
+     * @param component Component value
+     */
+    template<typename T>
+    void Add(Entity entity, T&& component);
+    /**
+     * Record adding a component to an entity, moving the value through its MetaType
+     * @param entity Entity to modify
+     * @param component Component ID
+     * @param value Initialized value, left in a moved-from state
+     */
+    void Add(Entity entity, ComponentId component, void* value);
+    /**
+     * Record removing a component from an entity
+     * @param entity Entity to modify
+     */
+    template<typename T>
+    void Remove(Entity entity);
+    void Remove(Entity entity, ComponentId component);
+
+    // Number of recorded commands
+    uint32_t Size() const;
+    bool Empty() const;
+    /**
+     * Discard all commands, destructing payloads that were not applied
+     */
+    void Clear();
+
+private:
+    friend class CommandQueue;
+
+    enum class CommandType : uint8_t
+    {
+        Spawn,
+        Despawn,
+        Add,
+        Remove
+    };
+
+    // Component attached to a command, `mData` is nullptr once it has been applied
+    struct Payload
+    {
+        ComponentId mComponent;
+        void* mData;
+    };
+
+    // Header of a command, followed in the arena by `mPayloadCount` payloads
+    struct Command
+    {
+        Payload* GetPayloads();
+
+        CommandType mType;
+        uint32_t mPayloadCount;
+        EntityKey mEntity;
+        Command* mNext;
+    };
+
+    struct Block
+    {
+        uint8_t* mData;
+        size_t mSize;
+    };
+
+    Command* Record(CommandType type, EntityKey entity, uint32_t payloads);
+    void* Allocate(size_t size, size_t alignment);
+    template<typename T>
+    Payload Construct(T&& value);
+
+    std::vector<Block> mBlocks;
+    size_t mBlock;
+    size_t mOffset;
+
+    Command* mFirst;
+    Command* mLast;
+    uint32_t mCount;
+};
+
+/*
+ ** Owns one `CommandBuffer` per thread, and applies them to a world.
+ *
+ * Applying sorts commands so each archetype is touched once per kind of change:
+ * - Commands are folded per entity, in recording order. Buffers are applied in the order they were created.
+ * - Entities moving between the same pair of archetypes are moved together, see `World::MoveBatch`.
+ * - Despawned entities are swapped to the end of their archetype and destructed in runs.
+ * - Spawned entities are grouped by component set.
+ */
+class CommandQueue
+{
+public:
+    CommandQueue();
+    CommandQueue(const CommandQueue& other) = delete;
+    CommandQueue& operator=(const CommandQueue& other) = delete;
+
+    /**
+     * Returns the buffer owned by the calling thread, creating it on first use
+     * @return Buffer
+     */
+    CommandBuffer& Local();
+    /**
+     * Apply and clear every buffer. Must not be called while other threads record commands.
+     * @param world World to modify
+     */
+    void Apply(World& world);
+    /**
+     * Discard every recorded command
+     */
+    void Clear();
+
+private:
+    using Command = CommandBuffer::Command;
+    using Payload = CommandBuffer::Payload;
+
+    // Final structural change of a single entity
+    struct Change
+    {
+        EntityKey mEntity;
+        uint32_t mSource;
+        uint32_t mDestination;
+        uint32_t mFirstAdded;
+        uint32_t mAddedCount;
+    };
+
+    static uint64_t NextId();
+
+    uint64_t mId;
+    std::mutex mMutex;
+    // Buffers in creation order, and the buffer of each thread
+    std::vector<std::unique_ptr<CommandBuffer>> mBuffers;
+    std::unordered_map<std::thread::id, CommandBuffer*> mThreadBuffers;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename... Ts>
+void CommandBuffer::Spawn(Ts&&... components)
+{
+    static_assert(UniqueTypes<std::decay_t<Ts>...>::value, "Entity spawned with duplicate components");
+
+    // Construct before recording, so a throwing constructor leaves no partial command behind
+    std::array<Payload, sizeof...(Ts)> payloads = {Construct(std::forward<Ts>(components))...};
+
+    // Sorted payloads let spawns be grouped by component set when applied
+    std::sort(payloads.begin(), payloads.end(), [](const Payload& lhs, const Payload& rhs)
+    {
+        return lhs.mComponent < rhs.mComponent;
+    });
+
+    Command* command = Record(CommandType::Spawn, EntityKey(), sizeof...(Ts));
+    std::copy(payloads.begin(), payloads.end(), command->GetPayloads());
+}
+
+template<typename T>
+void CommandBuffer::Add(Entity entity, T&& component)
+{
+    Payload payload = Construct(std::forward<T>(component));
+    Record(CommandType::Add, entity.mKey, 1)->GetPayloads()[0] = payload;
+}
+
+template<typename T>
+void CommandBuffer::Remove(Entity entity)
+{
+    Remove(entity, MetaTypeRegistry::GetId<T>());
+}
+
+template<typename T>
+CommandBuffer::Payload CommandBuffer::Construct(T&& value)
+{
+    using Component = std::decay_t<T>;
+    void* data = Allocate(sizeof(Component), alignof(Component));
+    new (data) Component(std::forward<T>(value));
+    return Payload{MetaTypeRegistry::GetId<Component>(), data};
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline CommandBuffer::Payload* CommandBuffer::Command::GetPayloads()
+{
+    return reinterpret_cast<Payload*>(this + 1);
+}
+
+inline CommandBuffer::CommandBuffer() :
+    mBlock(0), mOffset(0), mFirst(nullptr), mLast(nullptr), mCount(0)
+{
+}
+
+inline CommandBuffer::~CommandBuffer()
+{
+    Clear();
+    for (Block& block : mBlocks)
+        ::operator delete(block.mData, std::align_val_t(BlockAlignment));
+}
+
+inline void CommandBuffer::Despawn(Entity entity)
+{
+    Record(CommandType::Despawn, entity.mKey, 0);
+}
+
+inline void CommandBuffer::Add(Entity entity, ComponentId component, void* value)
+{
+    const MetaType& type = MetaTypeRegistry::Get(component);
+    void* data = Allocate(type.mDataSize, type.mDataAlignment);
+    type.mMoveConstruct(value, data, 1);
+
+    Command* command = Record(CommandType::Add, entity.mKey, 1);
+    command->GetPayloads()[0] = Payload{component, data};
+}
+
+inline void CommandBuffer::Remove(Entity entity, ComponentId component)
+{
+    Command* command = Record(CommandType::Remove, entity.mKey, 1);
+    command->GetPayloads()[0] = Payload{component, nullptr};
+}
+
+inline uint32_t CommandBuffer::Size() const
+{
+    return mCount;
+}
+
+inline bool CommandBuffer::Empty() const
+{
+    return mCount == 0;
+}
+
+inline void CommandBuffer::Clear()
+{
+    for (Command* command = mFirst; command; command = command->mNext)
+    {
+        Payload* payloads = command->GetPayloads();
+        for (uint32_t i = 0; i < command->mPayloadCount; ++i)
+        {
+            if (payloads[i].mData)
+                MetaTypeRegistry::Get(payloads[i].mComponent).DestructValues(payloads[i].mData, 1);
+        }
+    }
+
+    mBlock = 0;
+    mOffset = 0;
+    mFirst = nullptr;
+    mLast = nullptr;
+    mCount = 0;
+}
+
+inline CommandBuffer::Command* CommandBuffer::Record(CommandType type, EntityKey entity, uint32_t payloads)
+{
+    void* memory = Allocate(sizeof(Command) + sizeof(Payload) * payloads, alignof(Command));
+    Command* command = new (memory) Command{type, payloads, entity, nullptr};
+
+    (mLast ? mLast->mNext : mFirst) = command;
+    mLast = command;
+    ++mCount;
+    return command;
+}
+
+inline void* CommandBuffer::Allocate(size_t size, size_t alignment)
+{
+    while (true)
+    {
+        if (mBlock < mBlocks.size())
+        {
+            Block& block = mBlocks[mBlock];
+            uintptr_t start = reinterpret_cast<uintptr_t>(block.mData);
+            uintptr_t address = (start + mOffset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+            if (address + size <= start + block.mSize)
+            {
+                mOffset = address + size - start;
+                return reinterpret_cast<void*>(address);
+            }
+
+            ++mBlock;
+            mOffset = 0;
+            continue;
+        }
+
+        size_t bytes = std::max<size_t>(BlockSize, size + alignment);
+        mBlocks.push_back(Block{static_cast<uint8_t*>(
+            ::operator new(bytes, std::align_val_t(BlockAlignment))), bytes});
+    }
+}
+
+inline CommandQueue::CommandQueue() : mId(NextId())
+{
+}
+
+inline CommandBuffer& CommandQueue::Local()
+{
+    // Each thread caches the buffer of the last queue it recorded to, so the cache never grows. Queues are
+    // identified by a unique ID rather than their address, so a destroyed queue is never matched.
+    struct Cache
+    {
+        uint64_t mQueue = UINT64_MAX;
+        CommandBuffer* mBuffer = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.mQueue == mId)
+        return *cache.mBuffer;
+
+    std::lock_guard lock(mMutex);
+    CommandBuffer*& buffer = mThreadBuffers[std::this_thread::get_id()];
+    if (!buffer)
+    {
+        mBuffers.push_back(std::make_unique<CommandBuffer>());
+        buffer = mBuffers.back().get();
+    }
+    cache = Cache{mId, buffer};
+    return *buffer;
+}
+
+inline void CommandQueue::Clear()
+{
+    for (auto& buffer : mBuffers)
+        buffer->Clear();
+}
+
+inline void CommandQueue::Apply(World& world)
+{
+    std::vector<Command*> spawns;
+    std::vector<std::pair<EntityKey, Command*>> commands;
+    for (auto& buffer : mBuffers)
+    {
+        for (Command* command = buffer->mFirst; command; command = command->mNext)
+        {
+            if (command->mType == CommandBuffer::CommandType::Spawn)
+                spawns.push_back(command);
+            else if (world.mEntities.contains(command->mEntity))
+                commands.emplace_back(command->mEntity, command);
+        }
+    }
+
+    // Group commands per entity, keeping recording order within each entity
+    std::stable_sort(commands.begin(), commands.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.first.mIndex < rhs.first.mIndex;
+    });
+
+    std::vector<Change> changes;
+    std::vector<EntityKey> despawns;
+    std::vector<Payload*> added;
+    std::vector<std::pair<ComponentId, Payload*>> state;
+    for (size_t i = 0; i < commands.size();)
+    {
+        EntityKey entity = commands[i].first;
+        bool despawn = false;
+        state.clear();
+
+        // Fold the commands into the final set of added (payload) and removed (nullptr) components
+        for (; i < commands.size() && commands[i].first.mIndex == entity.mIndex; ++i)
+        {
+            Command* command = commands[i].second;
+            if (command->mType == CommandBuffer::CommandType::Despawn)
+            {
+                despawn = true;
+                continue;
+            }
+
+            Payload* payload = command->GetPayloads();
+            Payload* value = command->mType == CommandBuffer::CommandType::Add ? payload : nullptr;
+            auto found = std::find_if(state.begin(), state.end(), [&](const auto& entry)
+            {
+                return entry.first == payload->mComponent;
+            });
+            if (found == state.end())
+                state.emplace_back(payload->mComponent, value);
+            else
+                found->second = value;
+        }
+
+        if (despawn)
+        {
+            despawns.push_back(entity);
+            continue;
+        }
+
+        Archetype* source = world.mArchetypes[world.Locate(Entity(entity)).mArchetype].get();
+        Archetype* destination = source;
+        uint32_t first = static_cast<uint32_t>(added.size());
+        for (auto& [component, payload] : state)
+        {
+            bool contains = destination->GetColumn(component) != Archetype::InvalidColumn;
+            if (payload)
+            {
+                added.push_back(payload);
+                if (!contains)
+                    destination = &world.GetAddTarget(*destination, component);
+            }
+            else if (contains)
+            {
+                destination = &world.GetRemoveTarget(*destination, component);
+            }
+        }
+
+        changes.push_back(Change{entity, source->GetIndex(), destination->GetIndex(), first,
+                                 static_cast<uint32_t>(added.size()) - first});
+    }
+
+    // Move entities sharing a source and destination together, then construct their new components
+    std::sort(changes.begin(), changes.end(), [](const Change& lhs, const Change& rhs)
+    {
+        return std::tie(lhs.mSource, lhs.mDestination) < std::tie(rhs.mSource, rhs.mDestination);
+    });
+
+    std::vector<uint32_t> rows;
+    for (size_t i = 0; i < changes.size();)
+    {
+        size_t end = i;
+        while (end < changes.size() && changes[end].mSource == changes[i].mSource
+               && changes[end].mDestination == changes[i].mDestination)
+            ++end;
+
+        Archetype& source = *world.mArchetypes[changes[i].mSource];
+        Archetype& destination = *world.mArchetypes[changes[i].mDestination];
+        if (&source != &destination)
+        {
+            rows.clear();
+            for (size_t j = i; j < end; ++j)
+            {
+                ArchetypeEntity& location = world.Locate(Entity(changes[j].mEntity));
+                rows.push_back(location.mTable * source.GetLayout().mRowCount + location.mRow);
+            }
+            std::sort(rows.begin(), rows.end());
+            world.MoveBatch(source, destination, rows);
+        }
+
+        for (; i < end; ++i)
+        {
+            ArchetypeEntity& location = world.Locate(Entity(changes[i].mEntity));
+            Table& table = destination.GetTable(location.mTable);
+            for (uint32_t j = 0; j < changes[i].mAddedCount; ++j)
+            {
+                Payload* payload = added[changes[i].mFirstAdded + j];
+                uint32_t column = destination.GetColumn(payload->mComponent);
+                const MetaType& type = destination.GetLayout().mTypes[column];
+                void* value = table.GetValue(column, location.mRow);
+
+                // Replaced components were relocated along with the entity, and are still initialized
+                if (source.GetColumn(payload->mComponent) != Archetype::InvalidColumn)
+                    type.DestructValues(value, 1);
+                type.RelocateValues(payload->mData, value, 1);
+                table.InvalidateZone(column);
+                payload->mData = nullptr;
+            }
+        }
+    }
+
+    // Despawn per archetype, destructing rows in runs at the end of each archetype
+    std::vector<std::pair<uint32_t, uint32_t>> locations;
+    for (EntityKey entity : despawns)
+    {
+        ArchetypeEntity& location = world.Locate(Entity(entity));
+        uint32_t rowCount = world.mArchetypes[location.mArchetype]->GetLayout().mRowCount;
+        locations.emplace_back(location.mArchetype, location.mTable * rowCount + location.mRow);
+    }
+    std::sort(locations.begin(), locations.end());
+
+    for (size_t i = 0; i < locations.size();)
+    {
+        Archetype& archetype = *world.mArchetypes[locations[i].first];
+        rows.clear();
+        for (; i < locations.size() && locations[i].first == archetype.GetIndex(); ++i)
+            rows.push_back(locations[i].second);
+
+        world.SwapToTail(archetype, rows);
+        archetype.RemoveTail(static_cast<uint32_t>(rows.size()));
+    }
+    for (EntityKey entity : despawns)
+        world.mEntities.remove(entity);
+
+    // Spawn per component set, payloads are sorted by component when recorded
+    auto lessComponents = [](Command* lhs, Command* rhs)
+    {
+        return std::lexicographical_compare(
+            lhs->GetPayloads(), lhs->GetPayloads() + lhs->mPayloadCount,
+            rhs->GetPayloads(), rhs->GetPayloads() + rhs->mPayloadCount,
+            [](const Payload& a, const Payload& b) { return a.mComponent < b.mComponent; });
+    };
+    std::stable_sort(spawns.begin(), spawns.end(), lessComponents);
+
+    std::vector<ComponentId> components;
+    Archetype* archetype = nullptr;
+    for (size_t i = 0; i < spawns.size(); ++i)
+    {
+        Command* command = spawns[i];
+        Payload* payloads = command->GetPayloads();
+        if (i == 0 || lessComponents(spawns[i - 1], command))
+        {
+            components.clear();
+            for (uint32_t j = 0; j < command->mPayloadCount; ++j)
+                components.push_back(payloads[j].mComponent);
+            archetype = &world.GetArchetype(components);
+        }
+
+        Entity entity = world.mEntities.insert(ArchetypeEntity{});
+        ArchetypeEntity location = archetype->Allocate(entity.mKey);
+        world.mEntities.find(entity).get() = location;
+
+        // Payloads and columns are both sorted by component
+        Table& table = archetype->GetTable(location.mTable);
+        for (uint32_t j = 0; j < command->mPayloadCount; ++j)
+        {
+            archetype->GetLayout().mTypes[j].RelocateValues(payloads[j].mData, table.GetValue(j, location.mRow), 1);
+            payloads[j].mData = nullptr;
+        }
+    }
+
+    Clear();
+}
+
+inline uint64_t CommandQueue::NextId()
+{
+    static std::atomic<uint64_t> id(0);
+    return id.fetch_add(1);
+}
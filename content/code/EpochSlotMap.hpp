@@ -0,0 +1,413 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Slotmap.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** SlotMap variant with epoch-based reclamation, for readers running concurrently with writers.
+ */
+
+/*
+ ** SlotMap whose readers never block and never observe a destroyed value.
+ *
+ * Nodes are stored in fixed size pages that are never moved, so growth does not invalidate readers. Each node holds
+ * its generation and occupancy in a single atomic, published after the value is constructed.
+ *
+ * Writers are serialized by a mutex. `Remove` bumps the generation immediately, so the value disappears from new
+ * lookups, but destruction and slot reuse are deferred: the slot is retired with the current global epoch and only
+ * reclaimed once the epoch has advanced twice past it. The epoch only advances when every active reader has
+ * observed the current epoch, so no reader that could have seen the value is still running.
+ *
+ * Readers claim one of `MaxReaders` slots and announce the epoch they entered in, which costs a bounded scan and no
+ * locks. Read sections should be short (e.g. one frame), as a reader that stays active holds back reclamation.
+ *
+ * @tparam Value Value type
+ */
+template<typename Value>
+class EpochSlotMap
+{
+public:
+    using Key = SlotKey<uint32_t, uint32_t>;
+
+    // Nodes per page
+    static constexpr uint32_t PageSize = 1024;
+    // Maximum number of pages, bounding the map to PageSize * MaxPages values
+    static constexpr uint32_t MaxPages = 4096;
+    // Maximum number of concurrent readers
+    static constexpr uint32_t MaxReaders = 64;
+    // Number of retired slots that triggers a collection from `Remove`
+    static constexpr uint32_t CollectThreshold = 64;
+
+    /*
+     ** Active read section. Values reached through a reader stay alive until it is destroyed.
+     */
+    class Reader
+    {
+    public:
+        Reader(const Reader& other) = delete;
+        Reader& operator=(const Reader& other) = delete;
+        Reader(Reader&& other) noexcept;
+        Reader& operator=(Reader&& other) noexcept;
+        ~Reader();
+
+        /**
+         * Find a value
+         * @param key Key returned by `Insert`
+         * @return Value, or nullptr if the key was removed
+         */
+        const Value* Find(Key key) const;
+        /**
+         * Call a function on every value present when the node is visited
+         * @param function Called as `function(Key key, const Value& value)`
+         */
+        template<typename F>
+        void ForEach(F&& function) const;
+
+    private:
+        friend EpochSlotMap;
+        Reader(const EpochSlotMap* map, uint32_t slot);
+        void Release();
+
+        const EpochSlotMap* mMap;
+        uint32_t mSlot;
+    };
+
+    EpochSlotMap();
+    EpochSlotMap(const EpochSlotMap& other) = delete;
+    EpochSlotMap& operator=(const EpochSlotMap& other) = delete;
+    // No reader may be active
+    ~EpochSlotMap();
+
+    /**
+     * Insert a value
+     * @param value Value to insert
+     * @return Key referring to the value
+     */
+    Key Insert(Value value);
+    /**
+     * Remove a value. The value is destroyed once no reader can reach it.
+     * @param key Key of the value
+     * @return False if the key was already removed
+     */
+    bool Remove(Key key);
+    /**
+     * Advance the epoch if possible and reclaim retired slots no reader can reach
+     */
+    void Collect();
+
+    /**
+     * Enter a read section. Safe to call from any thread, concurrently with writers.
+     * @return Reader, leaving the read section when destroyed
+     */
+    Reader Read() const;
+
+    uint32_t Size() const;
+    // Removed values waiting to be destroyed
+    uint32_t RetiredCount() const;
+
+private:
+    struct Node
+    {
+        // Generation << 1 | occupied
+        std::atomic<uint64_t> mState{0};
+        alignas(Value) unsigned char mData[sizeof(Value)];
+
+        Value* Get();
+    };
+
+    struct Page
+    {
+        Node mNodes[PageSize];
+    };
+
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> mEpoch;
+    };
+
+    struct RetiredSlot
+    {
+        uint32_t mIndex;
+        uint64_t mEpoch;
+    };
+
+    // Epoch of a reader slot that is not in use
+    static constexpr uint64_t Unclaimed = UINT64_MAX;
+
+    Node& GetNode(uint32_t index) const;
+    bool TryAdvance();
+    void CollectLocked();
+
+    std::unique_ptr<std::atomic<Page*>[]> mPages;
+    std::atomic<uint32_t> mNodeCount;
+    std::atomic<uint32_t> mSize;
+
+    std::unique_ptr<ReaderSlot[]> mReaders;
+    std::atomic<uint64_t> mEpoch;
+
+    // Writer state, guarded by mWriteMutex
+    mutable std::mutex mWriteMutex;
+    std::vector<uint32_t> mFree;
+    std::vector<RetiredSlot> mRetired;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename Value>
+Value* EpochSlotMap<Value>::Node::Get()
+{
+    return std::launder(reinterpret_cast<Value*>(mData));
+}
+
+template<typename Value>
+EpochSlotMap<Value>::EpochSlotMap() :
+    mPages(new std::atomic<Page*>[MaxPages]), mNodeCount(0), mSize(0), mReaders(new ReaderSlot[MaxReaders]),
+    mEpoch(0)
+{
+    for (uint32_t i = 0; i < MaxPages; ++i)
+        mPages[i].store(nullptr, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < MaxReaders; ++i)
+        mReaders[i].mEpoch.store(Unclaimed, std::memory_order_relaxed);
+}
+
+template<typename Value>
+EpochSlotMap<Value>::~EpochSlotMap()
+{
+    uint32_t count = mNodeCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (GetNode(i).mState.load(std::memory_order_relaxed) & 1)
+            GetNode(i).Get()->~Value();
+    }
+    for (const RetiredSlot& retired : mRetired)
+        GetNode(retired.mIndex).Get()->~Value();
+
+    for (uint32_t i = 0; i < MaxPages; ++i)
+        delete mPages[i].load(std::memory_order_relaxed);
+}
+
+template<typename Value>
+typename EpochSlotMap<Value>::Key EpochSlotMap<Value>::Insert(Value value)
+{
+    std::lock_guard lock(mWriteMutex);
+
+    uint32_t index;
+    bool fresh = mFree.empty();
+    if (fresh)
+    {
+        index = mNodeCount.load(std::memory_order_relaxed);
+        uint32_t page = index / PageSize;
+        if (index % PageSize == 0)
+        {
+            if (page >= MaxPages)
+                throw std::runtime_error("EpochSlotMap is full");
+            mPages[page].store(new Page(), std::memory_order_release);
+        }
+    }
+    else
+    {
+        index = mFree.back();
+        mFree.pop_back();
+    }
+
+    Node& node = GetNode(index);
+    uint64_t generation = node.mState.load(std::memory_order_relaxed) >> 1;
+    new (node.mData) Value(std::move(value));
+    node.mState.store(generation << 1 | 1, std::memory_order_release);
+
+    // New nodes become visible to iteration only once initialized
+    if (fresh)
+        mNodeCount.store(index + 1, std::memory_order_release);
+    mSize.fetch_add(1, std::memory_order_relaxed);
+
+    return Key(static_cast<unsigned>(generation), index);
+}
+
+template<typename Value>
+bool EpochSlotMap<Value>::Remove(Key key)
+{
+    std::lock_guard lock(mWriteMutex);
+
+    if (key.mIndex >= mNodeCount.load(std::memory_order_relaxed))
+        return false;
+
+    Node& node = GetNode(key.mIndex);
+    uint64_t state = node.mState.load(std::memory_order_relaxed);
+    if (state != (static_cast<uint64_t>(key.mGeneration) << 1 | 1))
+        return false;
+
+    node.mState.store(static_cast<uint64_t>(key.mGeneration + 1) << 1, std::memory_order_seq_cst);
+    mRetired.push_back(RetiredSlot{key.mIndex, mEpoch.load(std::memory_order_seq_cst)});
+    mSize.fetch_sub(1, std::memory_order_relaxed);
+
+    if (mRetired.size() >= CollectThreshold)
+        CollectLocked();
+    return true;
+}
+
+template<typename Value>
+void EpochSlotMap<Value>::Collect()
+{
+    std::lock_guard lock(mWriteMutex);
+    CollectLocked();
+}
+
+template<typename Value>
+void EpochSlotMap<Value>::CollectLocked()
+{
+    // Slots retired in epoch e are unreachable once the epoch reaches e + 2
+    if (TryAdvance())
+        TryAdvance();
+    uint64_t epoch = mEpoch.load(std::memory_order_relaxed);
+
+    size_t kept = 0;
+    for (const RetiredSlot& retired : mRetired)
+    {
+        if (retired.mEpoch + 2 <= epoch)
+        {
+            GetNode(retired.mIndex).Get()->~Value();
+            mFree.push_back(retired.mIndex);
+        }
+        else
+        {
+            mRetired[kept++] = retired;
+        }
+    }
+    mRetired.resize(kept);
+}
+
+template<typename Value>
+bool EpochSlotMap<Value>::TryAdvance()
+{
+    uint64_t epoch = mEpoch.load(std::memory_order_seq_cst);
+    for (uint32_t i = 0; i < MaxReaders; ++i)
+    {
+        uint64_t reader = mReaders[i].mEpoch.load(std::memory_order_seq_cst);
+        if (reader != Unclaimed && reader != epoch)
+            return false;
+    }
+    mEpoch.store(epoch + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+template<typename Value>
+typename EpochSlotMap<Value>::Reader EpochSlotMap<Value>::Read() const
+{
+    uint64_t epoch = mEpoch.load(std::memory_order_seq_cst);
+
+    // Start from a per-thread position so concurrent readers rarely contend on the same slot
+    uint32_t start = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) % MaxReaders);
+    for (uint32_t i = 0; i < MaxReaders; ++i)
+    {
+        uint32_t slot = (start + i) % MaxReaders;
+        uint64_t expected = Unclaimed;
+        if (mReaders[slot].mEpoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst))
+        {
+            // Node states are read after the announcement is visible to writers
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return Reader(this, slot);
+        }
+    }
+    throw std::runtime_error("EpochSlotMap has too many concurrent readers");
+}
+
+template<typename Value>
+uint32_t EpochSlotMap<Value>::Size() const
+{
+    return mSize.load(std::memory_order_relaxed);
+}
+
+template<typename Value>
+uint32_t EpochSlotMap<Value>::RetiredCount() const
+{
+    std::lock_guard lock(mWriteMutex);
+    return static_cast<uint32_t>(mRetired.size());
+}
+
+template<typename Value>
+typename EpochSlotMap<Value>::Node& EpochSlotMap<Value>::GetNode(uint32_t index) const
+{
+    return mPages[index / PageSize].load(std::memory_order_acquire)->mNodes[index % PageSize];
+}
+
+template<typename Value>
+EpochSlotMap<Value>::Reader::Reader(const EpochSlotMap* map, uint32_t slot) : mMap(map), mSlot(slot)
+{
+}
+
+template<typename Value>
+EpochSlotMap<Value>::Reader::Reader(Reader&& other) noexcept : mMap(other.mMap), mSlot(other.mSlot)
+{
+    other.mMap = nullptr;
+}
+
+template<typename Value>
+typename EpochSlotMap<Value>::Reader& EpochSlotMap<Value>::Reader::operator=(Reader&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        mMap = other.mMap;
+        mSlot = other.mSlot;
+        other.mMap = nullptr;
+    }
+    return *this;
+}
+
+template<typename Value>
+EpochSlotMap<Value>::Reader::~Reader()
+{
+    Release();
+}
+
+template<typename Value>
+void EpochSlotMap<Value>::Reader::Release()
+{
+    if (mMap)
+        mMap->mReaders[mSlot].mEpoch.store(Unclaimed, std::memory_order_release);
+    mMap = nullptr;
+}
+
+template<typename Value>
+const Value* EpochSlotMap<Value>::Reader::Find(Key key) const
+{
+    if (key.mIndex >= mMap->mNodeCount.load(std::memory_order_acquire))
+        return nullptr;
+
+    Node& node = mMap->GetNode(key.mIndex);
+    if (node.mState.load(std::memory_order_acquire) != (static_cast<uint64_t>(key.mGeneration) << 1 | 1))
+        return nullptr;
+    return node.Get();
+}
+
+template<typename Value>
+template<typename F>
+void EpochSlotMap<Value>::Reader::ForEach(F&& function) const
+{
+    uint32_t count = mMap->mNodeCount.load(std::memory_order_acquire);
+    for (uint32_t page = 0; page * PageSize < count; ++page)
+    {
+        Page& nodes = *mMap->mPages[page].load(std::memory_order_acquire);
+        uint32_t end = std::min(PageSize, count - page * PageSize);
+        for (uint32_t i = 0; i < end; ++i)
+        {
+            uint64_t state = nodes.mNodes[i].mState.load(std::memory_order_acquire);
+            if (state & 1)
+                function(Key(static_cast<unsigned>(state >> 1), page * PageSize + i),
+                         static_cast<const Value&>(*nodes.mNodes[i].Get()));
+        }
+    }
+}
@@ -0,0 +1,307 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "MetaType.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Per-type memory accounting for containers built on `MetaType`.
+ *
+ * Define `METATYPE_MEMORY_ACCOUNTING` before including any container to enable it. When disabled every account is an
+ * empty object and reporting compiles to nothing. Types are keyed by their stable `TypeId`, so accounting does not
+ * depend on `MetaTypeRegistry`.
+ */
+
+/*
+ ** Memory used by a type across every container.
+ */
+struct MemoryStats
+{
+    // Stable type identifier, see `TypeId<T>()`
+    uint64_t mTypeId;
+    std::string_view mName;
+    // Bytes holding live values
+    int64_t mLiveBytes;
+    // Bytes allocated to hold values
+    int64_t mCapacityBytes;
+    // Allocated bytes not holding values
+    int64_t mSlackBytes;
+    // Containers currently holding an allocation
+    int64_t mAllocations;
+    // Allocations made since startup, including reallocations
+    int64_t mTotalAllocations;
+};
+
+/*
+ ** Global per-type counters, keyed by type ID.
+ */
+class MemoryAccounting
+{
+public:
+#ifdef METATYPE_MEMORY_ACCOUNTING
+    static constexpr bool Enabled = true;
+#else
+    static constexpr bool Enabled = false;
+#endif
+
+    /**
+     * Read the counters of every type that has reported memory
+     * @return Statistics, ordered by type ID
+     */
+    static std::vector<MemoryStats> Collect();
+    /**
+     * Write a table of every type that has reported memory
+     * @param out Stream to write to
+     */
+    static void Dump(std::ostream& out);
+
+private:
+    friend class MemoryAccount;
+
+    struct Counters
+    {
+        std::atomic<int64_t> mLiveBytes{0};
+        std::atomic<int64_t> mCapacityBytes{0};
+        std::atomic<int64_t> mAllocations{0};
+        std::atomic<int64_t> mTotalAllocations{0};
+    };
+
+    struct Entry
+    {
+        std::string_view mName;
+        std::unique_ptr<Counters> mCounters;
+    };
+
+    struct Storage
+    {
+        std::map<uint64_t, Entry> mEntries;
+        std::mutex mMutex;
+    };
+
+    static Storage& GetStorage();
+    static Counters* GetCounters(uint64_t typeId, std::string_view name);
+};
+
+/*
+ ** Memory reported by a single container for a single type.
+ *
+ * Containers call `Update` with their current totals after every change, and the difference from the previous report
+ * is applied to the global counters. Destroying an account reports zero. Copies report to the same type but start
+ * from zero, moves take over the reported totals along with the container's memory.
+ */
+class MemoryAccount
+{
+public:
+    MemoryAccount() = default;
+    MemoryAccount(const MemoryAccount& other);
+    MemoryAccount(MemoryAccount&& other) noexcept;
+    MemoryAccount& operator=(const MemoryAccount& other);
+    MemoryAccount& operator=(MemoryAccount&& other) noexcept;
+    ~MemoryAccount();
+
+    /**
+     * Create an account for a type
+     * @tparam T Type of the values
+     * @return Account
+     */
+    template<typename T>
+    static MemoryAccount For();
+    static MemoryAccount For(const MetaType& type);
+
+    /**
+     * Report the current memory of the container
+     * @param liveBytes Bytes holding live values
+     * @param capacityBytes Bytes allocated, a change counts as an allocation
+     */
+    void Update(size_t liveBytes, size_t capacityBytes);
+
+private:
+#ifdef METATYPE_MEMORY_ACCOUNTING
+    explicit MemoryAccount(MemoryAccounting::Counters* counters);
+
+    MemoryAccounting::Counters* mCounters = nullptr;
+    int64_t mLiveBytes = 0;
+    int64_t mCapacityBytes = 0;
+#endif
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename T>
+MemoryAccount MemoryAccount::For()
+{
+#ifdef METATYPE_MEMORY_ACCOUNTING
+    return MemoryAccount(MemoryAccounting::GetCounters(TypeId<T>(), TypeName<std::remove_cv_t<T>>()));
+#else
+    return MemoryAccount();
+#endif
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline MemoryAccounting::Storage& MemoryAccounting::GetStorage()
+{
+    static Storage storage;
+    return storage;
+}
+
+inline MemoryAccounting::Counters* MemoryAccounting::GetCounters(uint64_t typeId, std::string_view name)
+{
+    Storage& storage = GetStorage();
+    std::lock_guard lock(storage.mMutex);
+
+    Entry& entry = storage.mEntries[typeId];
+    if (!entry.mCounters)
+    {
+        entry.mName = name;
+        entry.mCounters = std::make_unique<Counters>();
+    }
+    return entry.mCounters.get();
+}
+
+inline std::vector<MemoryStats> MemoryAccounting::Collect()
+{
+    Storage& storage = GetStorage();
+    std::lock_guard lock(storage.mMutex);
+
+    std::vector<MemoryStats> out;
+    out.reserve(storage.mEntries.size());
+    for (const auto& [typeId, entry] : storage.mEntries)
+    {
+        const Counters& counters = *entry.mCounters;
+
+        MemoryStats stats{};
+        stats.mTypeId = typeId;
+        stats.mName = entry.mName;
+        stats.mLiveBytes = counters.mLiveBytes.load(std::memory_order_relaxed);
+        stats.mCapacityBytes = counters.mCapacityBytes.load(std::memory_order_relaxed);
+        stats.mSlackBytes = stats.mCapacityBytes - stats.mLiveBytes;
+        stats.mAllocations = counters.mAllocations.load(std::memory_order_relaxed);
+        stats.mTotalAllocations = counters.mTotalAllocations.load(std::memory_order_relaxed);
+        out.push_back(stats);
+    }
+    return out;
+}
+
+inline void MemoryAccounting::Dump(std::ostream& out)
+{
+    if (!Enabled)
+    {
+        out << "Memory accounting disabled, define METATYPE_MEMORY_ACCOUNTING to enable it\n";
+        return;
+    }
+
+    out << std::left << std::setw(40) << "Type" << std::right
+        << std::setw(14) << "Live" << std::setw(14) << "Capacity" << std::setw(14) << "Slack"
+        << std::setw(8) << "Allocs" << std::setw(10) << "Total" << '\n';
+    for (const MemoryStats& stats : Collect())
+    {
+        out << std::left << std::setw(40) << stats.mName << std::right
+            << std::setw(14) << stats.mLiveBytes << std::setw(14) << stats.mCapacityBytes
+            << std::setw(14) << stats.mSlackBytes << std::setw(8) << stats.mAllocations
+            << std::setw(10) << stats.mTotalAllocations << '\n';
+    }
+}
+
+#ifdef METATYPE_MEMORY_ACCOUNTING
+
+inline MemoryAccount::MemoryAccount(MemoryAccounting::Counters* counters) : mCounters(counters)
+{
+}
+
+inline MemoryAccount::MemoryAccount(const MemoryAccount& other) : mCounters(other.mCounters)
+{
+}
+
+inline MemoryAccount::MemoryAccount(MemoryAccount&& other) noexcept :
+    mCounters(other.mCounters), mLiveBytes(other.mLiveBytes), mCapacityBytes(other.mCapacityBytes)
+{
+    other.mLiveBytes = 0;
+    other.mCapacityBytes = 0;
+}
+
+inline MemoryAccount& MemoryAccount::operator=(const MemoryAccount& other)
+{
+    if (this != &other)
+    {
+        Update(0, 0);
+        mCounters = other.mCounters;
+    }
+    return *this;
+}
+
+inline MemoryAccount& MemoryAccount::operator=(MemoryAccount&& other) noexcept
+{
+    if (this != &other)
+    {
+        Update(0, 0);
+        mCounters = other.mCounters;
+        mLiveBytes = other.mLiveBytes;
+        mCapacityBytes = other.mCapacityBytes;
+        other.mLiveBytes = 0;
+        other.mCapacityBytes = 0;
+    }
+    return *this;
+}
+
+inline MemoryAccount::~MemoryAccount()
+{
+    Update(0, 0);
+}
+
+inline MemoryAccount MemoryAccount::For(const MetaType& type)
+{
+    return MemoryAccount(MemoryAccounting::GetCounters(type.mTypeId, type.mName));
+}
+
+inline void MemoryAccount::Update(size_t liveBytes, size_t capacityBytes)
+{
+    if (!mCounters)
+        return;
+
+    int64_t live = static_cast<int64_t>(liveBytes);
+    int64_t capacity = static_cast<int64_t>(capacityBytes);
+    if (live != mLiveBytes)
+        mCounters->mLiveBytes.fetch_add(live - mLiveBytes, std::memory_order_relaxed);
+    if (capacity != mCapacityBytes)
+    {
+        mCounters->mCapacityBytes.fetch_add(capacity - mCapacityBytes, std::memory_order_relaxed);
+        mCounters->mAllocations.fetch_add((capacity != 0) - (mCapacityBytes != 0), std::memory_order_relaxed);
+        if (capacity != 0)
+            mCounters->mTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    mLiveBytes = live;
+    mCapacityBytes = capacity;
+}
+
+#else
+
+inline MemoryAccount::MemoryAccount(const MemoryAccount&) = default;
+inline MemoryAccount::MemoryAccount(MemoryAccount&&) noexcept = default;
+inline MemoryAccount& MemoryAccount::operator=(const MemoryAccount&) = default;
+inline MemoryAccount& MemoryAccount::operator=(MemoryAccount&&) noexcept = default;
+inline MemoryAccount::~MemoryAccount() = default;
+
+inline MemoryAccount MemoryAccount::For(const MetaType&)
+{
+    return MemoryAccount();
+}
+
+inline void MemoryAccount::Update(size_t, size_t)
+{
+}
+
+#endif
@@ -1,6 +1,15 @@
 #pragma once
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <string_view>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
  * @author Will Bender
@@ -8,6 +17,231 @@
  ** Defines an interface to interact with types at runtime.
  */
 
+///////////////////////////////////
+/// Type Identifiers
+
+/**
+ * Returns the compiler's name for a type, extracted from the pretty-function signature.
+ * Names are only guaranteed to be stable between builds made with the same compiler.
+ * @tparam T Type to name
+ * @return Type name
+ */
+template<typename T>
+constexpr std::string_view TypeName()
+{
+#if defined(__clang__) || defined(__GNUC__)
+    constexpr std::string_view signature = __PRETTY_FUNCTION__;
+    constexpr std::string_view prefix = "T = ";
+    constexpr size_t start = signature.find(prefix) + prefix.size();
+    constexpr size_t end = signature.find_first_of(";]", start);
+#elif defined(_MSC_VER)
+    constexpr std::string_view signature = __FUNCSIG__;
+    constexpr std::string_view prefix = "TypeName<";
+    constexpr size_t start = signature.find(prefix) + prefix.size();
+    constexpr size_t end = signature.rfind(">(void)");
+#else
+#error "TypeName requires __PRETTY_FUNCTION__ or __FUNCSIG__"
+#endif
+    return signature.substr(start, end - start);
+}
+
+/**
+ * Hashes a string with 64 bit FNV-1a
+ * @param string String to hash
+ * @return Hash
+ */
+constexpr uint64_t Fnv1a(std::string_view string)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : string)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/**
+ * Stable identifier of a type, usable as a key in serialized data.
+ * cv-qualifiers are ignored, `const T` and `T` share an identifier.
+ * @tparam T Type to identify
+ * @return Type identifier
+ */
+template<typename T>
+constexpr uint64_t TypeId()
+{
+    return Fnv1a(TypeName<std::remove_cv_t<T>>());
+}
+
+/**
+ * Hashes raw bytes. Four independent lanes consume 32 bytes per iteration, which the compiler can keep in
+ * registers and vectorize.
+ * @param data Bytes to hash
+ * @param size Number of bytes
+ * @param seed Seed combined into the hash
+ * @return Hash
+ */
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    constexpr uint64_t prime = 0x9e3779b97f4a7c15ull;
+    auto mix = [](uint64_t lane, uint64_t word)
+    {
+        lane ^= word * 0xbf58476d1ce4e5b9ull;
+        lane = (lane << 31) | (lane >> 33);
+        return lane * 0x94d049bb133111ebull;
+    };
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t lanes[4] = {seed, seed + prime, seed + 2 * prime, seed + 3 * prime};
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        uint64_t words[4];
+        std::memcpy(words, bytes + i, 32);
+        for (int lane = 0; lane < 4; ++lane)
+            lanes[lane] = mix(lanes[lane], words[lane]);
+    }
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        lanes[0] = mix(lanes[0], word);
+    }
+    if (i < size)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i);
+        lanes[1] = mix(lanes[1], word);
+    }
+
+    uint64_t hash = size * prime;
+    for (uint64_t lane : lanes)
+        hash = mix(hash, lane);
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * Copies fixed size values between arrays with byte strides. The size is a constant, so each copy compiles to plain
+ * loads and stores, and a pair of dense strides becomes a single memcpy.
+ * @tparam Size Size of a value in bytes
+ * @param src First source value
+ * @param srcStride Bytes between source values
+ * @param dst First destination value
+ * @param dstStride Bytes between destination values
+ * @param count Number of values
+ */
+template<size_t Size>
+void CopyBytesStrided(const void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count)
+{
+    if (srcStride == Size && dstStride == Size)
+    {
+        std::memcpy(dst, src, Size * count);
+        return;
+    }
+
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for (uint32_t i = 0; i < count; ++i)
+        std::memcpy(out + i * dstStride, in + i * srcStride, Size);
+}
+
+///////////////////////////////////
+/// Comparison Hooks
+
+template<typename T, typename = void>
+struct HasEquality : std::false_type {};
+
+template<typename T>
+struct HasEquality<T, std::enable_if_t<
+    std::is_convertible_v<decltype(std::declval<const T&>() == std::declval<const T&>()), bool>>>
+    : std::true_type {};
+
+///////////////////////////////////
+/// Serialization Hooks
+
+/*
+ ** Detects serialization member hooks on non trivially copyable types:
+ *
+ * - `void Serialize(std::vector<uint8_t>& out) const`
+ * - `static const uint8_t* Deserialize(const uint8_t* in, const uint8_t* end, T* dst)`, constructing into `dst`
+ */
+template<typename T, typename = void>
+struct HasSerializeHooks : std::false_type {};
+
+template<typename T>
+struct HasSerializeHooks<T, std::void_t<
+    decltype(std::declval<const T&>().Serialize(std::declval<std::vector<uint8_t>&>())),
+    decltype(T::Deserialize(std::declval<const uint8_t*>(), std::declval<const uint8_t*>(), std::declval<T*>()))>>
+    : std::true_type {};
+
+///////////////////////////////////
+/// Zone Summaries
+
+/*
+ ** Customization point for per-table zone maps of a component.
+ *
+ * Specialize to keep a summary of every table column storing `T`, letting filtered queries skip tables whose summary
+ * cannot match (see `View::ForEachTableWhere`). A specialization provides:
+ *
+ * - `using Summary = ...`, trivially copyable, for example a `ZoneRange` or a bitmask of flags
+ * - `static Summary Empty()`, the summary of no values
+ * - `static void Include(Summary& summary, const T& value)`, widening the summary to contain a value
+ *
+ * Summaries only need to be conservative: they may contain values no longer stored in the table.
+ */
+template<typename T>
+struct ZoneTraits {};
+
+template<typename T, typename = void>
+struct HasZoneTraits : std::false_type {};
+
+template<typename T>
+struct HasZoneTraits<T, std::void_t<typename ZoneTraits<T>::Summary>> : std::true_type {};
+
+/*
+ ** Min/max summary of an ordered value, for use as a `ZoneTraits` summary.
+ */
+template<typename V>
+struct ZoneRange
+{
+    // Range containing no values, `mMin > mMax`
+    static ZoneRange Empty();
+
+    void Include(const V& value);
+    /**
+     * Check if the range may contain values within `[min, max]`
+     * @param min Lowest value, inclusive
+     * @param max Highest value, inclusive
+     * @return False if no value in the range lies within `[min, max]`
+     */
+    bool Overlaps(const V& min, const V& max) const;
+
+    V mMin;
+    V mMax;
+};
+
+///////////////////////////////////
+/// Typed Kernels
+
+/*
+ ** Compile-time kernels of a type, matching the lifecycle function pointers of `MetaType`.
+ *
+ * `MetaType::GenerateType` points its lifecycle hooks at these functions. Code that knows a component type at compile
+ * time calls them directly instead, so the loop inlines rather than making an indirect call per array.
+ */
+template<typename T>
+struct Typed
+{
+    static void DefaultConstruct(void* data, uint32_t count);
+    static void Destruct(void* data, uint32_t count);
+    static void MoveConstruct(void* src, void* dst, uint32_t count);
+    static void MoveAssign(void* src, void* dst, uint32_t count);
+    static void CopyConstruct(void* src, void* dst, uint32_t count);
+    static void CopyAssign(void* src, void* dst, uint32_t count);
+    static void Relocate(void* src, void* dst, uint32_t count);
+};
+
 ///////////////////////////////////
 /// Type Definitions 
 
@@ -42,6 +276,30 @@ struct MetaType
     using CopyConstruct =       void(*)(void* src, void* dst, uint32_t count);
     // Copies a value from an initialized structure to another initialized structure
     using CopyAssign =          void(*)(void* src, void* dst, uint32_t count);
+    // Moves a value to a memory location and destructs the source, leaving src uninitialized
+    using Relocate =            void(*)(void* src, void* dst, uint32_t count);
+    // Copies values between arrays with byte strides, constructing at dst. A source stride of 0 repeats one value.
+    using CopyConstructStrided =
+        void(*)(const void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count);
+    // Moves values between arrays with byte strides, constructing at dst
+    using MoveConstructStrided =
+        void(*)(void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count);
+    // Copies `src[indices[i]]` to the uninitialized `dst[i]`
+    using Gather =              void(*)(const void* src, const uint32_t* indices, void* dst, uint32_t count);
+    // Copies `src[i]` over the initialized `dst[indices[i]]`
+    using Scatter =             void(*)(const void* src, void* dst, const uint32_t* indices, uint32_t count);
+    // Appends the serialized form of values to a byte buffer
+    using Serialize =           void(*)(const void* src, uint32_t count, std::vector<uint8_t>& out);
+    // Constructs values from serialized bytes, returning the read position after the values
+    using Deserialize =         const uint8_t*(*)(const uint8_t* in, const uint8_t* end, void* dst, uint32_t count);
+    // Compares two arrays of values, returning true if every pair is equal
+    using Equals =              bool(*)(const void* lhs, const void* rhs, uint32_t count);
+    // Hashes an array of values, combined with a seed
+    using Hash =                uint64_t(*)(const void* data, uint32_t count, uint64_t seed);
+    // Resets a zone summary to contain no values
+    using ZoneReset =           void(*)(void* summary);
+    // Widens a zone summary to contain an array of values
+    using ZoneInclude =         void(*)(void* summary, const void* data, uint32_t count);
 
     
     ///////////////////////////////////
@@ -51,6 +309,16 @@ struct MetaType
         mDataSize,      // The size of the data in bytes
         mDataAlignment; // The alignment rules provided by alignas(n)
 
+    uint64_t mTypeId;       // Stable identifier, see `TypeId<T>()`
+    std::string_view mName; // Compiler provided name, see `TypeName<T>()`
+
+    bool mTriviallyRelocatable;  // Values can be relocated with memcpy, see `RelocateValues`
+    bool mTriviallyDestructible; // Destruction is a no-op, see `DestructValues`
+
+    uint32_t
+        mZoneSize,      // Size of the zone summary in bytes, 0 without `ZoneTraits`
+        mZoneAlignment; // Alignment of the zone summary
+
     
     /// Function Pointers
     
@@ -66,11 +334,144 @@ struct MetaType
     CopyConstruct       mCopyConstruct;
     // Copies a value from an initialized structure to another initialized structure
     CopyAssign          mCopyAssign;
+    // Moves a value to a memory location and destructs the source in a single pass.
+    // Trivially copyable types are relocated with a single memcpy.
+    Relocate            mRelocate;
+    // Strided copies, for converting interleaved (AoS) data to and from columns.
+    // Trivially copyable types copy each value with a fixed size memcpy, so strides need not be aligned and a pair of
+    // dense strides becomes a single memcpy. Other types require strides that keep every value aligned.
+    CopyConstructStrided mCopyConstructStrided;
+    MoveConstructStrided mMoveConstructStrided;
+    // Index list copies, trivially copyable types copy each value with a fixed size memcpy
+    Gather              mGather;
+    Scatter             mScatter;
+    // Appends the serialized form of values to a byte buffer.
+    // Trivially copyable types are copied as raw memory, other types must provide member hooks, see `GenerateType`.
+    Serialize           mSerialize;
+    // Constructs values from serialized bytes, throwing on truncated input
+    Deserialize         mDeserialize;
+    // Compares two arrays of values.
+    // Types with unique object representations are compared with memcmp, otherwise `operator==` is used. Trivially
+    // copyable types without `operator==` fall back to comparing bytes, where padding may report false differences.
+    Equals              mEquals;
+    // Hashes an array of values, consistent with `mEquals`
+    Hash                mHash;
+    // Zone summary hooks, only set for types specializing `ZoneTraits`
+    ZoneReset           mZoneReset;
+    ZoneInclude         mZoneInclude;
+
+    
+    ///////////////////////////////////
+    /// Helpers
+
+    /**
+     * Removes the value at `index` from an array by relocating the value at `last` into its place.
+     * After the call `last` is uninitialized, and the array can be shrunk by one.
+     * @param column Array of values of this type
+     * @param index Index of the value to remove
+     * @param last Index of the last initialized value in the array
+     */
+    void SwapRemove(void* column, uint32_t index, uint32_t last) const;
+    /**
+     * Relocates values, copying trivially relocatable types inline rather than calling `mRelocate`
+     * @param src Initialized values, uninitialized afterwards
+     * @param dst Uninitialized memory
+     * @param count Number of values
+     */
+    void RelocateValues(void* src, void* dst, uint32_t count) const;
+    /**
+     * Destructs values, skipping the call to `mDestruct` for trivially destructible types
+     * @param data Values to destruct
+     * @param count Number of values
+     */
+    void DestructValues(void* data, uint32_t count) const;
 };
 
 ///////////////////////////////////
 /// Template Implementations
 
+template<typename V>
+ZoneRange<V> ZoneRange<V>::Empty()
+{
+    return ZoneRange{std::numeric_limits<V>::max(), std::numeric_limits<V>::lowest()};
+}
+
+template<typename V>
+void ZoneRange<V>::Include(const V& value)
+{
+    mMin = std::min(mMin, value);
+    mMax = std::max(mMax, value);
+}
+
+template<typename V>
+bool ZoneRange<V>::Overlaps(const V& min, const V& max) const
+{
+    return !(max < mMin || mMax < min);
+}
+
+template<typename T>
+void Typed<T>::DefaultConstruct(void* data, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+        new (static_cast<T*>(data) + i) T();
+}
+
+template<typename T>
+void Typed<T>::Destruct(void* data, uint32_t count)
+{
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        for(uint32_t i = 0; i < count; ++i)
+            static_cast<T*>(data)[i].~T();
+    }
+}
+
+template<typename T>
+void Typed<T>::MoveConstruct(void* src, void* dst, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+        new (static_cast<T*>(dst) + i) T(std::move(static_cast<T*>(src)[i]));
+}
+
+template<typename T>
+void Typed<T>::MoveAssign(void* src, void* dst, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+        static_cast<T*>(dst)[i] = std::move(static_cast<T*>(src)[i]);
+}
+
+template<typename T>
+void Typed<T>::CopyConstruct(void* src, void* dst, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+        new (static_cast<T*>(dst) + i) T(static_cast<T*>(src)[i]);
+}
+
+template<typename T>
+void Typed<T>::CopyAssign(void* src, void* dst, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+        static_cast<T*>(dst)[i] = static_cast<T*>(src)[i];
+}
+
+template<typename T>
+void Typed<T>::Relocate(void* src, void* dst, uint32_t count)
+{
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        std::memcpy(dst, src, sizeof(T) * count);
+    }
+    else
+    {
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            T& value = static_cast<T*>(src)[i];
+            new (static_cast<T*>(dst) + i) T(std::move(value));
+            value.~T();
+        }
+    }
+}
+
 template<typename T>
 MetaType MetaType::GenerateType()
 {
@@ -80,38 +481,205 @@ MetaType MetaType::GenerateType()
     out.mDataSize = sizeof(T);
     out.mDataAlignment = alignof(T);
 
-    
-    // Generate lambda functions with known function signatures
-    out.mDefaultConstruct = [](void* data, uint32_t count)
+    // Fill in identification
+    out.mTypeId = TypeId<T>();
+    out.mName = TypeName<std::remove_cv_t<T>>();
+
+    // Fill in fast path flags
+    out.mTriviallyRelocatable = std::is_trivially_copyable_v<T>;
+    out.mTriviallyDestructible = std::is_trivially_destructible_v<T>;
+
+    // Lifecycle hooks point at the typed kernels, operations the type does not support are left nullptr
+    out.mDestruct = &Typed<T>::Destruct;
+    if constexpr (std::is_default_constructible_v<T>)
+        out.mDefaultConstruct = &Typed<T>::DefaultConstruct;
+    if constexpr (std::is_move_constructible_v<T>)
     {
-        for(uint32_t i = 0; i < count; ++i)
-            new (static_cast<T*>(data) + i) T();
-    };
-    out.mDestruct = [](void* data, uint32_t count)
+        out.mMoveConstruct = &Typed<T>::MoveConstruct;
+        out.mRelocate = &Typed<T>::Relocate;
+    }
+    if constexpr (std::is_move_assignable_v<T>)
+        out.mMoveAssign = &Typed<T>::MoveAssign;
+    if constexpr (std::is_copy_constructible_v<T>)
+        out.mCopyConstruct = &Typed<T>::CopyConstruct;
+    if constexpr (std::is_copy_assignable_v<T>)
+        out.mCopyAssign = &Typed<T>::CopyAssign;
+
+    if constexpr (std::is_trivially_copyable_v<T>)
     {
-        for(uint32_t i = 0; i < count; ++i)
-            static_cast<T*>(data)[i].~T();
-    };
-    out.mMoveConstruct = [](void* src, void* dst, uint32_t count)
+        out.mCopyConstructStrided = [](const void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count)
+        {
+            CopyBytesStrided<sizeof(T)>(src, srcStride, dst, dstStride, count);
+        };
+        out.mMoveConstructStrided = [](void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count)
+        {
+            CopyBytesStrided<sizeof(T)>(src, srcStride, dst, dstStride, count);
+        };
+        out.mGather = [](const void* src, const uint32_t* indices, void* dst, uint32_t count)
+        {
+            const uint8_t* in = static_cast<const uint8_t*>(src);
+            uint8_t* out = static_cast<uint8_t*>(dst);
+            for(uint32_t i = 0; i < count; ++i)
+                std::memcpy(out + i * sizeof(T), in + static_cast<size_t>(indices[i]) * sizeof(T), sizeof(T));
+        };
+        out.mScatter = [](const void* src, void* dst, const uint32_t* indices, uint32_t count)
+        {
+            const uint8_t* in = static_cast<const uint8_t*>(src);
+            uint8_t* out = static_cast<uint8_t*>(dst);
+            for(uint32_t i = 0; i < count; ++i)
+                std::memcpy(out + static_cast<size_t>(indices[i]) * sizeof(T), in + i * sizeof(T), sizeof(T));
+        };
+    }
+    else
     {
-        for(uint32_t i = 0; i < count; ++i)
-            new (static_cast<T*>(dst) + i) T(std::move(*static_cast<T*>(src)));
-    };
-    out.mMoveAssign = [](void* src, void* dst, uint32_t count)
+        if constexpr (std::is_copy_constructible_v<T>)
+        {
+            out.mCopyConstructStrided =
+                [](const void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count)
+            {
+                const uint8_t* in = static_cast<const uint8_t*>(src);
+                uint8_t* out = static_cast<uint8_t*>(dst);
+                for(uint32_t i = 0; i < count; ++i)
+                    new (out + i * dstStride) T(*reinterpret_cast<const T*>(in + i * srcStride));
+            };
+            out.mGather = [](const void* src, const uint32_t* indices, void* dst, uint32_t count)
+            {
+                for(uint32_t i = 0; i < count; ++i)
+                    new (static_cast<T*>(dst) + i) T(static_cast<const T*>(src)[indices[i]]);
+            };
+        }
+        if constexpr (std::is_move_constructible_v<T>)
+        {
+            out.mMoveConstructStrided = [](void* src, size_t srcStride, void* dst, size_t dstStride, uint32_t count)
+            {
+                uint8_t* in = static_cast<uint8_t*>(src);
+                uint8_t* out = static_cast<uint8_t*>(dst);
+                for(uint32_t i = 0; i < count; ++i)
+                    new (out + i * dstStride) T(std::move(*reinterpret_cast<T*>(in + i * srcStride)));
+            };
+        }
+        if constexpr (std::is_copy_assignable_v<T>)
+        {
+            out.mScatter = [](const void* src, void* dst, const uint32_t* indices, uint32_t count)
+            {
+                for(uint32_t i = 0; i < count; ++i)
+                    static_cast<T*>(dst)[indices[i]] = static_cast<const T*>(src)[i];
+            };
+        }
+    }
+    
+    if constexpr (std::is_trivially_copyable_v<T>)
     {
-        for(uint32_t i = 0; i < count; ++i)
-            static_cast<T*>(dst)[i] = std::move(*static_cast<T*>(src));
-    };
-    out.mCopyConstruct = [](void* src, void* dst, uint32_t count)
+        out.mSerialize = [](const void* src, uint32_t count, std::vector<uint8_t>& buffer)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(src);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * count);
+        };
+        out.mDeserialize = [](const uint8_t* in, const uint8_t* end, void* dst, uint32_t count)
+        {
+            size_t size = sizeof(T) * count;
+            if (static_cast<size_t>(end - in) < size)
+                throw std::runtime_error("Deserialized past the end of the input");
+            std::memcpy(dst, in, size);
+            return in + size;
+        };
+    }
+    else if constexpr (HasSerializeHooks<T>::value)
     {
-        for(uint32_t i = 0; i < count; ++i)
-            new (static_cast<T*>(dst) + i) T(*static_cast<T*>(src));
-    };
-    out.mCopyAssign = [](void* src, void* dst, uint32_t count)
+        out.mSerialize = [](const void* src, uint32_t count, std::vector<uint8_t>& buffer)
+        {
+            for(uint32_t i = 0; i < count; ++i)
+                static_cast<const T*>(src)[i].Serialize(buffer);
+        };
+        out.mDeserialize = [](const uint8_t* in, const uint8_t* end, void* dst, uint32_t count)
+        {
+            for(uint32_t i = 0; i < count; ++i)
+                in = T::Deserialize(in, end, static_cast<T*>(dst) + i);
+            return in;
+        };
+    }
+
+    if constexpr (std::has_unique_object_representations_v<T>
+                  || (std::is_trivially_copyable_v<T> && !HasEquality<T>::value))
     {
-        for(uint32_t i = 0; i < count; ++i)
-            static_cast<T*>(dst)[i] = static_cast<T*>(*src);
-    };
+        out.mEquals = [](const void* lhs, const void* rhs, uint32_t count)
+        {
+            return std::memcmp(lhs, rhs, sizeof(T) * count) == 0;
+        };
+        out.mHash = [](const void* data, uint32_t count, uint64_t seed)
+        {
+            return HashBytes(data, sizeof(T) * count, seed);
+        };
+    }
+    else if constexpr (HasEquality<T>::value)
+    {
+        out.mEquals = [](const void* lhs, const void* rhs, uint32_t count)
+        {
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                if (!(static_cast<const T*>(lhs)[i] == static_cast<const T*>(rhs)[i]))
+                    return false;
+            }
+            return true;
+        };
+        if constexpr (std::is_default_constructible_v<std::hash<T>>)
+        {
+            out.mHash = [](const void* data, uint32_t count, uint64_t seed)
+            {
+                for(uint32_t i = 0; i < count; ++i)
+                {
+                    uint64_t value = std::hash<T>()(static_cast<const T*>(data)[i]);
+                    seed = HashBytes(&value, sizeof(value), seed);
+                }
+                return seed;
+            };
+        }
+    }
+
+    if constexpr (HasZoneTraits<T>::value)
+    {
+        using Summary = typename ZoneTraits<T>::Summary;
+        static_assert(std::is_trivially_copyable_v<Summary>, "Zone summaries must be trivially copyable");
+
+        out.mZoneSize = sizeof(Summary);
+        out.mZoneAlignment = alignof(Summary);
+        out.mZoneReset = [](void* summary)
+        {
+            *static_cast<Summary*>(summary) = ZoneTraits<T>::Empty();
+        };
+        out.mZoneInclude = [](void* summary, const void* data, uint32_t count)
+        {
+            Summary& zone = *static_cast<Summary*>(summary);
+            for(uint32_t i = 0; i < count; ++i)
+                ZoneTraits<T>::Include(zone, static_cast<const T*>(data)[i]);
+        };
+    }
     
     return out;
 }
+
+///////////////////////////////////
+/// Implementations
+
+inline void MetaType::SwapRemove(void* column, uint32_t index, uint32_t last) const
+{
+    uint8_t* data = static_cast<uint8_t*>(column);
+
+    DestructValues(data + static_cast<size_t>(index) * mDataSize, 1);
+    if (index != last)
+        RelocateValues(data + static_cast<size_t>(last) * mDataSize, data + static_cast<size_t>(index) * mDataSize, 1);
+}
+
+inline void MetaType::RelocateValues(void* src, void* dst, uint32_t count) const
+{
+    if (mTriviallyRelocatable)
+        std::memcpy(dst, src, static_cast<size_t>(mDataSize) * count);
+    else
+        mRelocate(src, dst, count);
+}
+
+inline void MetaType::DestructValues(void* data, uint32_t count) const
+{
+    if (!mTriviallyDestructible)
+        mDestruct(data, count);
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "MetaType.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Stores every generated `MetaType` exactly once, indexed by a dense runtime ID.
+ */
+
+/*
+ ** Global registry of MetaTypes.
+ *
+ * Each type is generated once and stored in fixed size pages that are never moved or freed. Types are referred to by
+ * their dense index, which is assigned in registration order and only valid for the current process. Use the stable
+ * `MetaType::mTypeId` when writing IDs to serialized data, and `Find` to convert it back.
+ *
+ * Lookup by type goes through a function local static and does not hash. `Get` does not lock and may run concurrently
+ * with registration on other threads, references it returns stay valid for the lifetime of the process.
+ */
+class MetaTypeRegistry
+{
+public:
+    using Id = uint32_t;
+    static constexpr Id InvalidId = UINT32_MAX;
+    // Types per page of storage
+    static constexpr uint32_t PageSize = 256;
+    // Maximum number of pages, bounding the number of types
+    static constexpr uint32_t MaxPages = 1024;
+
+    /**
+     * Registers a type if it has not been registered already
+     * @tparam T Type to register, cv-qualifiers are ignored
+     * @return Dense ID of the type
+     */
+    template<typename T>
+    static Id Register();
+    /**
+     * Registers a generated type if it has not been registered already
+     * @param type Type to register
+     * @return Dense ID of the type
+     */
+    static Id Register(const MetaType& type);
+
+    /**
+     * Returns the dense ID of a type, registering it on first use
+     * @tparam T Type to look up, cv-qualifiers are ignored
+     * @return Dense ID of the type
+     */
+    template<typename T>
+    static Id GetId();
+
+    /**
+     * Returns the MetaType stored at a dense ID
+     * @param id Dense ID
+     * @return MetaType
+     */
+    static const MetaType& Get(Id id);
+
+    /**
+     * Finds the dense ID of a type from its stable type ID
+     * @param typeId Stable type ID, see `TypeId<T>()`
+     * @return Dense ID, or `InvalidId` if the type was never registered
+     */
+    static Id Find(uint64_t typeId);
+
+    /**
+     * Number of registered types
+     * @return Count
+     */
+    static uint32_t Size();
+
+private:
+    struct Storage
+    {
+        // Pages are allocated under the mutex, and published to readers by the release store to `mSize`
+        std::array<std::unique_ptr<MetaType[]>, MaxPages> mPages;
+        std::atomic<uint32_t> mSize{0};
+        std::unordered_map<uint64_t, Id> mTypeIds;
+        std::mutex mMutex;
+    };
+
+    static Storage& GetStorage();
+    static Id Insert(const MetaType& type);
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename T>
+MetaTypeRegistry::Id MetaTypeRegistry::Register()
+{
+    return Insert(MetaType::GenerateType<std::remove_cv_t<T>>());
+}
+
+template<typename T>
+MetaTypeRegistry::Id MetaTypeRegistry::GetId()
+{
+    static const Id id = Register<T>();
+    return id;
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline MetaTypeRegistry::Storage& MetaTypeRegistry::GetStorage()
+{
+    static Storage storage;
+    return storage;
+}
+
+inline MetaTypeRegistry::Id MetaTypeRegistry::Insert(const MetaType& type)
+{
+    Storage& storage = GetStorage();
+    std::lock_guard lock(storage.mMutex);
+
+    auto found = storage.mTypeIds.find(type.mTypeId);
+    if (found != storage.mTypeIds.end())
+    {
+        const MetaType& existing = storage.mPages[found->second / PageSize][found->second % PageSize];
+        if (existing.mName != type.mName)
+            throw std::runtime_error("Type ID collision between " + std::string(type.mName) + " and "
+                + std::string(existing.mName));
+        return found->second;
+    }
+
+    Id id = storage.mSize.load(std::memory_order_relaxed);
+    if (id == PageSize * MaxPages)
+        throw std::runtime_error("MetaTypeRegistry is full");
+
+    std::unique_ptr<MetaType[]>& page = storage.mPages[id / PageSize];
+    if (!page)
+        page = std::make_unique<MetaType[]>(PageSize);
+    page[id % PageSize] = type;
+    storage.mTypeIds.emplace(type.mTypeId, id);
+
+    storage.mSize.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+inline MetaTypeRegistry::Id MetaTypeRegistry::Register(const MetaType& type)
+{
+    return Insert(type);
+}
+
+inline const MetaType& MetaTypeRegistry::Get(Id id)
+{
+    Storage& storage = GetStorage();
+    // Synchronizes with the registration of the type, including the allocation of its page
+    if (id >= storage.mSize.load(std::memory_order_acquire))
+        throw std::runtime_error("MetaTypeRegistry ID out of range");
+    return storage.mPages[id / PageSize][id % PageSize];
+}
+
+inline MetaTypeRegistry::Id MetaTypeRegistry::Find(uint64_t typeId)
+{
+    Storage& storage = GetStorage();
+    std::lock_guard lock(storage.mMutex);
+
+    auto found = storage.mTypeIds.find(typeId);
+    return found == storage.mTypeIds.end() ? InvalidId : found->second;
+}
+
+inline uint32_t MetaTypeRegistry::Size()
+{
+    return GetStorage().mSize.load(std::memory_order_acquire);
+}
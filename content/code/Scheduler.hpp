@@ -0,0 +1,267 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "World.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Parallel system scheduler.
+ *
+ * Systems declare the components they read and write. Systems whose access does not conflict run concurrently, and
+ * systems added later wait on every earlier system they conflict with, so results match running them in order.
+ */
+
+/*
+ ** Components accessed by a system.
+ */
+struct SystemAccess
+{
+    /**
+     * Build the access of a query, `const T` is read only while `T` is written, see `QueryTraits`
+     * @tparam Ts Query components
+     * @return Access
+     */
+    template<typename... Ts>
+    static SystemAccess From();
+    /**
+     * Access that conflicts with every other system, for systems making structural changes
+     * @return Access
+     */
+    static SystemAccess Exclusive();
+
+    /**
+     * Check if two systems can not run at the same time
+     * @param other Other access
+     * @return Conflicts
+     */
+    bool Conflicts(const SystemAccess& other) const;
+
+    std::vector<ComponentId> mReads;  // Sorted components read
+    std::vector<ComponentId> mWrites; // Sorted components written
+    bool mExclusive = false;
+};
+
+/*
+ ** Runs systems on a thread pool, respecting their declared access.
+ */
+class Scheduler
+{
+public:
+    using SystemFunction = std::function<void(World& world, ThreadPool& pool)>;
+
+    /**
+     * Create a scheduler
+     * @param pool Pool running systems
+     */
+    explicit Scheduler(ThreadPool& pool);
+
+    /**
+     * Add a system running a function for every entity matching a query. Tables are split into chunks across the
+     * pool, so the function is called concurrently.
+     * @tparam Ts Query components, see `QueryTraits`
+     * @param name Name of the system
+     * @param function Called as `function(Ts&... components)`
+     * @param grain Number of tables per chunk
+     * @return System index
+     */
+    template<typename... Ts, typename F>
+    uint32_t AddSystem(std::string name, F&& function, uint32_t grain = 1);
+    /**
+     * Add a system with explicit access
+     * @param name Name of the system
+     * @param access Components accessed by the function
+     * @param function System function
+     * @return System index
+     */
+    uint32_t AddSystem(std::string name, SystemAccess access, SystemFunction function);
+
+    /**
+     * Run every system once, returning when all systems finish. A system that throws does not stop its dependents,
+     * the first exception is rethrown once the frame finishes.
+     * @param world World passed to systems
+     */
+    void Run(World& world);
+
+    uint32_t SystemCount() const;
+    const std::string& GetName(uint32_t system) const;
+    // Systems that must finish before the given system starts
+    const std::vector<uint32_t>& GetDependencies(uint32_t system) const;
+
+private:
+    struct System
+    {
+        std::string mName;
+        SystemAccess mAccess;
+        SystemFunction mFunction;
+        std::vector<uint32_t> mDependencies;
+        std::vector<uint32_t> mDependents;
+    };
+
+    void Launch(uint32_t system, World& world, std::atomic<uint32_t>* remaining, ThreadPool::Counter& counter);
+
+    ThreadPool& mPool;
+    std::vector<System> mSystems;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename... Ts>
+SystemAccess SystemAccess::From()
+{
+    SystemAccess out;
+    ((QueryTraits<Ts>::ReadOnly ? out.mReads : out.mWrites)
+         .push_back(MetaTypeRegistry::GetId<typename QueryTraits<Ts>::Component>()), ...);
+
+    for (std::vector<ComponentId>* list : {&out.mReads, &out.mWrites})
+    {
+        std::sort(list->begin(), list->end());
+        list->erase(std::unique(list->begin(), list->end()), list->end());
+    }
+
+    // Components both read and written only need to be written
+    std::vector<ComponentId> reads;
+    std::set_difference(out.mReads.begin(), out.mReads.end(), out.mWrites.begin(), out.mWrites.end(),
+                        std::back_inserter(reads));
+    out.mReads = std::move(reads);
+    return out;
+}
+
+template<typename... Ts, typename F>
+uint32_t Scheduler::AddSystem(std::string name, F&& function, uint32_t grain)
+{
+    // The view persists across runs, so each run only matches archetypes created since the previous one
+    return AddSystem(std::move(name), SystemAccess::From<Ts...>(),
+                     [function = std::forward<F>(function), grain, view = std::shared_ptr<View<Ts...>>()]
+                     (World& world, ThreadPool& pool) mutable
+                     {
+                         // Compared by ID, a new world may reuse the address of a destroyed one
+                         if (!view || view->GetWorldId() != world.GetId())
+                             view = std::make_shared<View<Ts...>>(world);
+                         view->ParallelForEach(pool, function, grain);
+                     });
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline SystemAccess SystemAccess::Exclusive()
+{
+    SystemAccess out;
+    out.mExclusive = true;
+    return out;
+}
+
+inline bool SystemAccess::Conflicts(const SystemAccess& other) const
+{
+    if (mExclusive || other.mExclusive)
+        return true;
+
+    auto intersects = [](const std::vector<ComponentId>& lhs, const std::vector<ComponentId>& rhs)
+    {
+        auto l = lhs.begin(), r = rhs.begin();
+        while (l != lhs.end() && r != rhs.end())
+        {
+            if (*l == *r)
+                return true;
+            *l < *r ? ++l : ++r;
+        }
+        return false;
+    };
+
+    return intersects(mWrites, other.mWrites)
+        || intersects(mWrites, other.mReads)
+        || intersects(mReads, other.mWrites);
+}
+
+inline Scheduler::Scheduler(ThreadPool& pool) : mPool(pool)
+{
+}
+
+inline uint32_t Scheduler::AddSystem(std::string name, SystemAccess access, SystemFunction function)
+{
+    uint32_t index = static_cast<uint32_t>(mSystems.size());
+
+    System system{std::move(name), std::move(access), std::move(function), {}, {}};
+    for (uint32_t i = 0; i < index; ++i)
+    {
+        if (mSystems[i].mAccess.Conflicts(system.mAccess))
+        {
+            system.mDependencies.push_back(i);
+            mSystems[i].mDependents.push_back(index);
+        }
+    }
+
+    mSystems.push_back(std::move(system));
+    return index;
+}
+
+inline void Scheduler::Run(World& world)
+{
+    uint32_t count = static_cast<uint32_t>(mSystems.size());
+    if (count == 0)
+        return;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> remaining(new std::atomic<uint32_t>[count]);
+    for (uint32_t i = 0; i < count; ++i)
+        remaining[i].store(static_cast<uint32_t>(mSystems[i].mDependencies.size()), std::memory_order_relaxed);
+
+    ThreadPool::Counter counter(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (mSystems[i].mDependencies.empty())
+            Launch(i, world, remaining.get(), counter);
+    }
+    mPool.Wait(counter);
+}
+
+inline uint32_t Scheduler::SystemCount() const
+{
+    return static_cast<uint32_t>(mSystems.size());
+}
+
+inline const std::string& Scheduler::GetName(uint32_t system) const
+{
+    return mSystems[system].mName;
+}
+
+inline const std::vector<uint32_t>& Scheduler::GetDependencies(uint32_t system) const
+{
+    return mSystems[system].mDependencies;
+}
+
+inline void Scheduler::Launch(uint32_t system, World& world, std::atomic<uint32_t>* remaining,
+                              ThreadPool::Counter& counter)
+{
+    mPool.Submit([this, system, &world, remaining, &counter]
+    {
+        // Dependents are launched even if the system throws, otherwise the counter never reaches zero
+        auto launchDependents = [&]()
+        {
+            for (uint32_t dependent : mSystems[system].mDependents)
+            {
+                if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    Launch(dependent, world, remaining, counter);
+            }
+        };
+
+        try
+        {
+            mSystems[system].mFunction(world, mPool);
+        }
+        catch (...)
+        {
+            launchDependents();
+            throw;
+        }
+        launchDependents();
+    }, &counter);
+}
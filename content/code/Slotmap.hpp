@@ -3,11 +3,21 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <stdint.h>
 
+#ifdef METATYPE_MEMORY_ACCOUNTING
+#include "MemoryAccounting.hpp"
+#endif
+
 /**
  * Slotmap Data Structure
  *
@@ -147,8 +157,9 @@ private:
      */
     struct Node
     {
+        Node() : uNextFree(SIZE_MAX), mHasData(false) {}
         Node(Value&& data, unsigned generation);
-        Node(const Node& other) = delete;
+        Node(const Node& other);
         Node(Node&& other) noexcept;
         Node& operator=(const Node& other) = delete;
         Node& operator=(Node&& other) noexcept = delete;
@@ -172,6 +183,13 @@ private:
     std::vector<Node> mNodes;
     size_t mFreeList;
     mutable uint32_t mSize;
+#ifdef METATYPE_MEMORY_ACCOUNTING
+    // Reports node memory under `Value`, live bytes count occupied nodes. Compiled out when accounting is disabled, so
+    // the `SlotMap` stays standalone and no larger than its nodes and free list.
+    MemoryAccount mAccount = MemoryAccount::For<Value>();
+#endif
+
+    void Account();
     
 public:
     
@@ -234,7 +252,7 @@ public:
     // Const iterator for `SlotMap`
     class const_iterator
     {
-        const_iterator(SlotMap* map, size_t index) : mPtr(map), mIndex(index)
+        const_iterator(const SlotMap* map, size_t index) : mPtr(map), mIndex(index)
         {
         }
 
@@ -261,48 +279,59 @@ public:
         // Returns a const pointer to the corresponding data contained within `SlotMap`
         pointer operator->() const;
         // Increments the iterator
-        iterator& operator++();
+        const_iterator& operator++();
         // Increments a new iterator
-        iterator operator++(int);
+        const_iterator operator++(int);
 
         reference get() const;
 
         Key GetKey();
 
         // Equality Function
-        friend bool operator==(const iterator& a, const iterator& b)
+        friend bool operator==(const const_iterator& a, const const_iterator& b)
         {
             return a.mPtr == b.mPtr && a.mIndex == b.mIndex;
         }
 
         // Inequality Function
-        friend bool operator!=(const iterator& a, const iterator& b)
+        friend bool operator!=(const const_iterator& a, const const_iterator& b)
         {
             return !(a == b);
         }
     };
 
     // Create a new `SlotMap`
-    SlotMap() : mNodes(), mFreeList(SIZE_MAX)
+    SlotMap() : mNodes(), mFreeList(SIZE_MAX), mSize(0)
     {
     }
-    // Copy an iterator into a `SlotMap`
-    template <typename I>
-    SlotMap(I& data) : mNodes(data.begin(), data.end()), mFreeList(SIZE_MAX)
+    // Insert every value of a range into a new `SlotMap`
+    template <typename I, typename = std::enable_if_t<!std::is_same_v<std::decay_t<I>, SlotMap>>>
+    SlotMap(I& data) : SlotMap()
     {
+        for (auto& value : data)
+            insert(Value(value));
     }
     // Move `SlotMap` data into another 
-    SlotMap(SlotMap&& other) noexcept : mNodes(std::move(other.mNodes)), mFreeList(other.mFreeList)
+    SlotMap(SlotMap&& other) noexcept : mNodes(std::move(other.mNodes)), mFreeList(other.mFreeList), mSize(other.mSize)
+#ifdef METATYPE_MEMORY_ACCOUNTING
+        , mAccount(std::move(other.mAccount))
+#endif
     {
     }
 
     // Copy a SlotMap from one to another
-    SlotMap(const SlotMap& other) : mNodes(other.mNodes), mFreeList(other.mFreeList)
+    SlotMap(const SlotMap& other) : mNodes(other.mNodes), mFreeList(other.mFreeList), mSize(other.mSize)
+#ifdef METATYPE_MEMORY_ACCOUNTING
+        , mAccount(other.mAccount)
+#endif
     {
+        Account();
     }
 
-    SlotMap(std::initializer_list<Value> initializerList) : mNodes(initializerList), mFreeList(SIZE_MAX)
+    SlotMap(std::initializer_list<Value> initializerList) : SlotMap()
     {
+        for (const Value& value : initializerList)
+            insert(Value(value));
     }
 
     /**
@@ -396,6 +425,21 @@ public:
 
     uint32_t Size() const;
 
+    /**
+     * Append the `SlotMap` to a byte buffer. Nodes are written column by column (generations, occupancy, then
+     * values), so each column is a single sequential write. Requires a trivially copyable `Value`.
+     * @param out Buffer to append to
+     */
+    void Serialize(std::vector<uint8_t>& out) const;
+    /**
+     * Replace the contents of the `SlotMap` with data written by `Serialize`. Throws on truncated or inconsistent
+     * input, leaving the `SlotMap` unchanged.
+     * @param in Start of the serialized data
+     * @param end End of the input
+     * @return Read position after the `SlotMap`
+     */
+    const uint8_t* Deserialize(const uint8_t* in, const uint8_t* end);
+
 };
 
 
@@ -494,8 +538,24 @@ IndexType SlotMap<Value, IndexType, GenerationType>::TypedKey::GetIndex() const
 }
 
 template <typename Value, typename IndexType, typename GenerationType>
-SlotMap<Value, IndexType, GenerationType>::Node::Node(Value&& data, unsigned generation): uData(data), mGeneration(generation), mHasData(true)
+SlotMap<Value, IndexType, GenerationType>::Node::Node(Value&& data, unsigned generation): uData(std::move(data)),
+    mGeneration(generation), mHasData(true)
+{
+}
+
+template <typename Value, typename IndexType, typename GenerationType>
+SlotMap<Value, IndexType, GenerationType>::Node::Node(const Node& other)
 {
+    mHasData = other.mHasData;
+    mGeneration = other.mGeneration;
+    if(mHasData)
+    {
+        new (&uData) Value(other.uData);
+    }
+    else
+    {
+        uNextFree = other.uNextFree;
+    }
 }
 
 template <typename Value, typename IndexType, typename GenerationType>
@@ -505,7 +565,7 @@ SlotMap<Value, IndexType, GenerationType>::Node::Node(Node&& other) noexcept
     mGeneration = other.mGeneration;
     if(mHasData)
     {
-        uData = other.uData;
+        new (&uData) Value(std::move(other.uData));
     }
     else
     {
@@ -560,18 +620,9 @@ typename SlotMap<Value, GenerationType, IndexType>::iterator& SlotMap<
 
     mIndex++;
 
-    if (mIndex >= mPtr->mNodes.size())
-        return *this;
-
-    while (!mPtr->mNodes[mIndex].mHasData)
-    {
-        if (mIndex >= mPtr->mNodes.size())
-        {
-            return *this;
-        }
-
+    // Skip free nodes, stopping at the end
+    while (mIndex < mPtr->mNodes.size() && !mPtr->mNodes[mIndex].mHasData)
         mIndex++;
-    }
     return *this;
 }
 
@@ -602,7 +653,7 @@ template <typename Value, typename IndexType, typename GenerationType>
 typename SlotMap<Value, IndexType, GenerationType>::Key SlotMap<Value, IndexType, GenerationType>::iterator::GetKey()
 {
     auto& map = mPtr->mNodes[mIndex];
-    return Key{map.mGeneration, mIndex};
+    return Key(map.mGeneration, static_cast<unsigned>(mIndex));
 }
 
 template <typename Value, typename GenerationType, typename IndexType>
@@ -620,7 +671,7 @@ typename SlotMap<Value, GenerationType, IndexType>::const_iterator::pointer Slot
 }
 
 template <typename Value, typename GenerationType, typename IndexType>
-typename SlotMap<Value, GenerationType, IndexType>::iterator& SlotMap<
+typename SlotMap<Value, GenerationType, IndexType>::const_iterator& SlotMap<
     Value, GenerationType, IndexType>::const_iterator::operator++()
 {
     if (mIndex >= mPtr->mNodes.size())
@@ -630,26 +681,17 @@ typename SlotMap<Value, GenerationType, IndexType>::iterator& SlotMap<
 
     mIndex++;
 
-    if (mIndex >= mPtr->mNodes.size())
-        return *this;
-
-    while (!mPtr->mNodes[mIndex].has_data)
-    {
-        if (mIndex >= mPtr->mNodes.size())
-        {
-            return *this;
-        }
-
+    // Skip free nodes, stopping at the end
+    while (mIndex < mPtr->mNodes.size() && !mPtr->mNodes[mIndex].mHasData)
         mIndex++;
-    }
     return *this;
 }
 
 template <typename Value, typename GenerationType, typename IndexType>
-typename SlotMap<Value, GenerationType, IndexType>::iterator SlotMap<
+typename SlotMap<Value, GenerationType, IndexType>::const_iterator SlotMap<
     Value, GenerationType, IndexType>::const_iterator::operator++(int)
 {
-    iterator out = *this;
+    const_iterator out = *this;
     ++(*this);
     return out;
 }
@@ -666,7 +708,7 @@ typename SlotMap<Value, IndexType, GenerationType>::Key SlotMap<Value, IndexType
 GetKey()
 {
     auto& map = mPtr->mNodes[mIndex];
-    return Key{map.mGeneration, mIndex};   
+    return Key(map.mGeneration, static_cast<unsigned>(mIndex));   
 }
 
 template <typename Value, typename GenerationType, typename IndexType>
@@ -680,12 +722,14 @@ typename SlotMap<Value, GenerationType, IndexType>::TypedKey SlotMap<Value, Gene
         mNodes[mFreeList].mHasData = true;
         mFreeList = next;
         ++mSize;
+        Account();
         return key;
     }
 
     Key key(0, static_cast<unsigned>(mNodes.size()));
     mNodes.emplace_back(std::move(data), 0);
     ++mSize;
+    Account();
     return TypedKey{key};
 }
 
@@ -709,6 +753,7 @@ void SlotMap<Value, GenerationType, IndexType>::remove(Key key)
     node.mHasData = false;
     mFreeList = key.mIndex;
     --mSize;
+    Account();
 }
 
 template <typename Value, typename IndexType, typename GenerationType>
@@ -735,9 +780,10 @@ bool SlotMap<Value, GenerationType, IndexType>::TryRemove(Key key)
     node.uData.~Value();
     node.uNextFree = mFreeList;
     node.mHasData = false;
-    mFreeList = key.index;
+    mFreeList = key.mIndex;
 
     --mSize;
+    Account();
 
     return true;
 }
@@ -768,13 +814,12 @@ typename SlotMap<Value, GenerationType, IndexType>::iterator SlotMap<
     if (iter.mPtr != this)
         throw std::runtime_error("Attempted to remove value from incorrect SlotMap");
 
-    if (iter.mPtr == end())
-        throw std::runtime_error("Erased called with end iterator");
-
     if (iter.mIndex >= mNodes.size())
-        throw std::runtime_error("Attempted to remove value with invalid index");
+        throw std::runtime_error("Erased called with end iterator");
 
     Node& node = mNodes[iter.mIndex];
+    if (!node.mHasData)
+        throw std::runtime_error("Attempted to remove value that was already removed");
 
     node.mGeneration += 1;
     node.uData.~Value();
@@ -782,9 +827,10 @@ typename SlotMap<Value, GenerationType, IndexType>::iterator SlotMap<
     node.mHasData = false;
     mFreeList = iter.mIndex;
 
-    ++iter.mIndex;
+    ++iter;
 
     --mSize;
+    Account();
 
     return iter;
 }
@@ -796,23 +842,23 @@ typename SlotMap<Value, GenerationType, IndexType>::const_iterator SlotMap<Value
     if (iter.mPtr != this)
         throw std::runtime_error("Attempted to remove value from incorrect SlotMap");
 
-    if (iter.mPtr == end())
-        throw std::runtime_error("Erased called with end iterator");
-
     if (iter.mIndex >= mNodes.size())
-        throw std::runtime_error("Attempted to remove value with invalid index");
+        throw std::runtime_error("Erased called with end iterator");
 
     Node& node = mNodes[iter.mIndex];
+    if (!node.mHasData)
+        throw std::runtime_error("Attempted to remove value that was already removed");
 
     node.mGeneration += 1;
-    node.uData.~T();
+    node.uData.~Value();
     node.uNextFree = mFreeList;
     node.mHasData = false;
     mFreeList = iter.mIndex;
 
-    ++iter.mIndex;
+    ++iter;
 
-    ++mSize;
+    --mSize;
+    Account();
 
     return iter;
 }
@@ -820,14 +866,20 @@ typename SlotMap<Value, GenerationType, IndexType>::const_iterator SlotMap<Value
 template <typename Value, typename GenerationType, typename IndexType>
 typename SlotMap<Value, GenerationType, IndexType>::iterator SlotMap<Value, GenerationType, IndexType>::begin()
 {
-    return iterator(this, 0);
+    iterator out(this, 0);
+    if (!mNodes.empty() && !mNodes[0].mHasData)
+        ++out;
+    return out;
 }
 
 template <typename Value, typename GenerationType, typename IndexType>
 typename SlotMap<Value, GenerationType, IndexType>::const_iterator SlotMap<
     Value, GenerationType, IndexType>::begin() const
 {
-    return const_iterator(this, 0);
+    const_iterator out(this, 0);
+    if (!mNodes.empty() && !mNodes[0].mHasData)
+        ++out;
+    return out;
 }
 
 template <typename Value, typename GenerationType, typename IndexType>
@@ -933,3 +985,100 @@ uint32_t SlotMap<_Value, _IndexType, _GenerationType>::Size() const
 {
     return mSize;
 }
+
+template <typename _Value, typename _IndexType, typename _GenerationType>
+void SlotMap<_Value, _IndexType, _GenerationType>::Serialize(std::vector<uint8_t>& out) const
+{
+    static_assert(std::is_trivially_copyable_v<Value>, "SlotMap serialization requires a trivially copyable Value");
+    // Bytes written per node for the value/free list union
+    constexpr size_t slot = std::max(sizeof(Value), sizeof(size_t));
+
+    auto write = [&out](const void* data, size_t size)
+    {
+        out.insert(out.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    };
+
+    uint64_t header[3] = {mNodes.size(), mFreeList, mSize};
+    write(header, sizeof(header));
+
+    size_t start = out.size();
+    out.resize(start + mNodes.size() * (sizeof(unsigned) + 1 + slot));
+    uint8_t* generations = out.data() + start;
+    uint8_t* occupied = generations + mNodes.size() * sizeof(unsigned);
+    uint8_t* values = occupied + mNodes.size();
+
+    for (size_t i = 0; i < mNodes.size(); ++i)
+    {
+        const Node& node = mNodes[i];
+        std::memcpy(generations + i * sizeof(unsigned), &node.mGeneration, sizeof(unsigned));
+        occupied[i] = node.mHasData;
+        if (node.mHasData)
+            std::memcpy(values + i * slot, &node.uData, sizeof(Value));
+        else
+            std::memcpy(values + i * slot, &node.uNextFree, sizeof(size_t));
+    }
+}
+
+template <typename _Value, typename _IndexType, typename _GenerationType>
+const uint8_t* SlotMap<_Value, _IndexType, _GenerationType>::Deserialize(const uint8_t* in, const uint8_t* end)
+{
+    static_assert(std::is_trivially_copyable_v<Value>, "SlotMap serialization requires a trivially copyable Value");
+    // Bytes written per node for the value/free list union
+    constexpr size_t slot = std::max(sizeof(Value), sizeof(size_t));
+
+    uint64_t header[3];
+    if (static_cast<size_t>(end - in) < sizeof(header))
+        throw std::runtime_error("SlotMap deserialized past the end of the input");
+    std::memcpy(header, in, sizeof(header));
+    in += sizeof(header);
+
+    size_t count = header[0];
+    // Divided rather than multiplied, so a corrupt count cannot overflow past the check
+    if (count > static_cast<size_t>(end - in) / (sizeof(unsigned) + 1 + slot))
+        throw std::runtime_error("SlotMap deserialized past the end of the input");
+
+    const uint8_t* generations = in;
+    const uint8_t* occupied = generations + count * sizeof(unsigned);
+    const uint8_t* values = occupied + count;
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i)
+        size += occupied[i] != 0;
+    if (header[2] != size)
+        throw std::runtime_error("SlotMap size does not match its occupied nodes");
+
+    // The free list may only link free nodes, and is cyclic if it is longer than their count
+    size_t steps = 0;
+    for (size_t free = static_cast<size_t>(header[1]); free != SIZE_MAX; ++steps)
+    {
+        if (free >= count || occupied[free] != 0 || steps == count - size)
+            throw std::runtime_error("SlotMap free list is corrupt");
+        std::memcpy(&free, values + free * slot, sizeof(size_t));
+    }
+
+    mNodes.clear();
+    mNodes.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Node& node = mNodes[i];
+        std::memcpy(&node.mGeneration, generations + i * sizeof(unsigned), sizeof(unsigned));
+        node.mHasData = occupied[i] != 0;
+        if (node.mHasData)
+            std::memcpy(&node.uData, values + i * slot, sizeof(Value));
+        else
+            std::memcpy(&node.uNextFree, values + i * slot, sizeof(size_t));
+    }
+
+    mFreeList = static_cast<size_t>(header[1]);
+    mSize = static_cast<uint32_t>(header[2]);
+    Account();
+    return values + count * slot;
+}
+
+template <typename _Value, typename _IndexType, typename _GenerationType>
+void SlotMap<_Value, _IndexType, _GenerationType>::Account()
+{
+#ifdef METATYPE_MEMORY_ACCOUNTING
+    mAccount.Update(static_cast<size_t>(mSize) * sizeof(Node), mNodes.capacity() * sizeof(Node));
+#endif
+}
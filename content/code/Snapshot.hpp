@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** Whole-world binary snapshots.
+ *
+ * Layout:
+ * - Header: magic, version
+ * - Entity provider, see `SlotMap::Serialize`
+ * - Archetype count, then per archetype:
+ *     - Component count, then the stable type ID of each component
+ *     - Entity count
+ *     - Each component column, written through `MetaType::mSerialize` one table at a time
+ *     - The entity column
+ *
+ * Columns are written as whole table runs, so trivially copyable components are saved and restored with one memcpy
+ * per table. Values are written in host byte order.
+ */
+class WorldSnapshot
+{
+public:
+    static constexpr uint32_t Magic = 0x53534c4e; // "NLSS"
+    static constexpr uint32_t Version = 1;
+
+    /**
+     * Append a snapshot of a world to a byte buffer
+     * @param world World to save, every component must have serialization hooks
+     * @param out Buffer to append to
+     */
+    static void Save(World& world, std::vector<uint8_t>& out);
+    /**
+     * Restore a snapshot into an empty world. Every component type must be registered in the current process,
+     * see `MetaTypeRegistry::Find`. Throws on malformed input, leaving the world empty.
+     * @param world Empty world
+     * @param in Snapshot data
+     * @param size Size of the snapshot in bytes
+     */
+    static void Load(World& world, const uint8_t* in, size_t size);
+    static void Load(World& world, const std::vector<uint8_t>& in);
+
+private:
+    template<typename T>
+    static void Write(std::vector<uint8_t>& out, const T& value);
+    template<typename T>
+    static T Read(const uint8_t*& in, const uint8_t* end);
+    static void Require(const uint8_t* in, const uint8_t* end, size_t size);
+    // Restore the entity provider and every archetype, see `Load`
+    static void Restore(World& world, const uint8_t* in, const uint8_t* end);
+    /**
+     * Deserialize the columns of freshly allocated rows. If the input is malformed, the values constructed so far are
+     * destructed and the rows removed before rethrowing.
+     * @param archetype Archetype whose rows are all uninitialized
+     * @param saved Components in saved column order
+     * @return Read position after the columns
+     */
+    static const uint8_t* RestoreColumns(Archetype& archetype, const std::vector<ComponentId>& saved,
+                                         const uint8_t* in, const uint8_t* end);
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename T>
+void WorldSnapshot::Write(std::vector<uint8_t>& out, const T& value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+T WorldSnapshot::Read(const uint8_t*& in, const uint8_t* end)
+{
+    Require(in, end, sizeof(T));
+    T out;
+    std::memcpy(&out, in, sizeof(T));
+    in += sizeof(T);
+    return out;
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline void WorldSnapshot::Save(World& world, std::vector<uint8_t>& out)
+{
+    // Reserve the full size up front so large columns are appended without reallocating
+    size_t estimate = 0;
+    uint32_t archetypes = 0;
+    for (auto& archetype : world.mArchetypes)
+    {
+        if (archetype->Size() == 0)
+            continue;
+
+        ++archetypes;
+        uint32_t rowSize = sizeof(EntityKey);
+        for (const MetaType& type : archetype->GetLayout().mTypes)
+        {
+            if (!type.mSerialize)
+                throw std::runtime_error("Component " + std::string(type.mName) + " has no serialization hooks");
+            rowSize += type.mDataSize;
+        }
+        estimate += static_cast<size_t>(rowSize) * archetype->Size();
+    }
+    out.reserve(out.size() + estimate + world.mEntities.Size() * 32);
+
+    Write(out, Magic);
+    Write(out, Version);
+    world.mEntities.Serialize(out);
+
+    Write(out, archetypes);
+    for (auto& archetype : world.mArchetypes)
+    {
+        if (archetype->Size() == 0)
+            continue;
+
+        const TableLayout& layout = archetype->GetLayout();
+        Write(out, static_cast<uint32_t>(layout.mTypes.size()));
+        for (const MetaType& type : layout.mTypes)
+            Write(out, type.mTypeId);
+        Write(out, archetype->Size());
+
+        uint32_t tables = archetype->TableCount();
+        for (uint32_t column = 0; column < layout.mTypes.size(); ++column)
+        {
+            for (uint32_t i = 0; i < tables; ++i)
+            {
+                const Table& table = archetype->GetTable(i);
+                layout.mTypes[column].mSerialize(table.GetColumn(column), table.mCount, out);
+            }
+        }
+
+        for (uint32_t i = 0; i < tables; ++i)
+        {
+            const Table& table = archetype->GetTable(i);
+            const uint8_t* entities = reinterpret_cast<const uint8_t*>(table.GetEntities());
+            out.insert(out.end(), entities, entities + sizeof(EntityKey) * table.mCount);
+        }
+    }
+}
+
+inline void WorldSnapshot::Load(World& world, const uint8_t* in, size_t size)
+{
+    if (world.Size() != 0)
+        throw std::runtime_error("Snapshots can only be loaded into an empty world");
+
+    // Free slots of the empty world, restored along with the emptied archetypes if loading fails
+    std::vector<uint8_t> entities;
+    world.mEntities.Serialize(entities);
+
+    try
+    {
+        Restore(world, in, in + size);
+    }
+    catch (...)
+    {
+        for (uint32_t i = 0; i < world.ArchetypeCount(); ++i)
+        {
+            Archetype& archetype = world.GetArchetype(i);
+            archetype.RemoveTail(archetype.Size());
+        }
+        world.mEntities.Deserialize(entities.data(), entities.data() + entities.size());
+        throw;
+    }
+}
+
+inline void WorldSnapshot::Restore(World& world, const uint8_t* in, const uint8_t* end)
+{
+    if (Read<uint32_t>(in, end) != Magic)
+        throw std::runtime_error("Invalid snapshot - bad magic");
+    if (Read<uint32_t>(in, end) != Version)
+        throw std::runtime_error("Invalid snapshot - unsupported version");
+
+    in = world.mEntities.Deserialize(in, end);
+
+    uint32_t archetypes = Read<uint32_t>(in, end);
+    std::vector<ComponentId> saved, components;
+    // Rows restored over every archetype
+    uint64_t rows = 0;
+    for (uint32_t a = 0; a < archetypes; ++a)
+    {
+        uint32_t count = Read<uint32_t>(in, end);
+        saved.clear();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t typeId = Read<uint64_t>(in, end);
+            ComponentId component = MetaTypeRegistry::Find(typeId);
+            if (component == MetaTypeRegistry::InvalidId)
+                throw std::runtime_error("Invalid snapshot - component type " + std::to_string(typeId)
+                    + " is not registered");
+            saved.push_back(component);
+        }
+
+        // Dense IDs may be ordered differently in this process, so columns are matched by component
+        components = saved;
+        std::sort(components.begin(), components.end());
+        if (std::adjacent_find(components.begin(), components.end()) != components.end())
+            throw std::runtime_error("Invalid snapshot - component saved twice in an archetype");
+        Archetype& archetype = world.GetArchetype(components);
+        if (archetype.Size() != 0)
+            throw std::runtime_error("Invalid snapshot - archetype saved twice");
+        const TableLayout& layout = archetype.GetLayout();
+        for (ComponentId component : saved)
+        {
+            if (!layout.mTypes[archetype.GetColumn(component)].mDeserialize)
+                throw std::runtime_error("Component " + std::string(MetaTypeRegistry::Get(component).mName)
+                    + " has no serialization hooks");
+        }
+
+        // Bounded by the input and the entity provider before allocating, so a corrupt count cannot overflow
+        uint32_t entities = Read<uint32_t>(in, end);
+        Require(in, end, static_cast<size_t>(entities) * sizeof(EntityKey));
+        rows += entities;
+        if (rows > world.mEntities.Size())
+            throw std::runtime_error("Invalid snapshot - more archetype rows than entities");
+        archetype.AllocateTail(entities);
+        in = RestoreColumns(archetype, saved, in, end);
+
+        // Components are initialized from here on, so `Load` destructs the rows if the entity column is invalid
+        for (uint32_t i = 0; i < archetype.TableCount(); ++i)
+        {
+            Table& table = archetype.GetTable(i);
+            size_t bytes = sizeof(EntityKey) * table.mCount;
+            Require(in, end, bytes);
+            std::memcpy(table.GetEntities(), in, bytes);
+            in += bytes;
+
+            for (uint32_t row = 0; row < table.mCount; ++row)
+            {
+                if (!world.mEntities.contains(table.GetEntities()[row]))
+                    throw std::runtime_error("Invalid snapshot - archetype row of a dead entity");
+            }
+        }
+
+        // Archetype indices and table sizes may differ from the saving process, so locations are rebuilt
+        world.UpdateLocations(archetype, 0, entities);
+    }
+
+    // Every row holds a live entity and there are as many rows as entities, so each entity must be found at its own
+    // location for every entity to be stored exactly once
+    if (rows != world.mEntities.Size())
+        throw std::runtime_error("Invalid snapshot - entities without an archetype row");
+    for (EntityProvider::iterator iter = world.mEntities.begin(); iter != world.mEntities.end(); ++iter)
+    {
+        const ArchetypeEntity& location = *iter;
+        if (location.mArchetype >= world.ArchetypeCount()
+            || location.mTable >= world.GetArchetype(location.mArchetype).TableCount())
+            throw std::runtime_error("Invalid snapshot - entity stored more than once");
+
+        const Table& table = world.GetArchetype(location.mArchetype).GetTable(location.mTable);
+        if (location.mRow >= table.mCount || table.GetEntities()[location.mRow] != iter.GetKey())
+            throw std::runtime_error("Invalid snapshot - entity stored more than once");
+    }
+}
+
+inline const uint8_t* WorldSnapshot::RestoreColumns(Archetype& archetype, const std::vector<ComponentId>& saved,
+                                                    const uint8_t* in, const uint8_t* end)
+{
+    const TableLayout& layout = archetype.GetLayout();
+    uint32_t tables = archetype.TableCount();
+
+    // Columns fully restored, and rows restored within the current column
+    uint32_t restored = 0;
+    uint32_t rows = 0;
+    try
+    {
+        for (; restored < saved.size(); ++restored)
+        {
+            uint32_t column = archetype.GetColumn(saved[restored]);
+            const MetaType& type = layout.mTypes[column];
+            for (uint32_t i = 0; i < tables; ++i)
+            {
+                Table& table = archetype.GetTable(i);
+                // Values needing destruction are restored one at a time, so a throw leaves no partial run
+                uint32_t run = type.mTriviallyDestructible ? table.mCount : 1;
+                for (uint32_t row = 0; row < table.mCount; row += run)
+                {
+                    in = type.mDeserialize(in, end, table.GetValue(column, row), run);
+                    rows += run;
+                }
+            }
+            rows = 0;
+        }
+    }
+    catch (...)
+    {
+        for (uint32_t c = 0; c <= restored && c < saved.size(); ++c)
+        {
+            uint32_t column = archetype.GetColumn(saved[c]);
+            uint32_t remaining = c < restored ? archetype.Size() : rows;
+            for (uint32_t i = 0; i < tables && remaining != 0; ++i)
+            {
+                Table& table = archetype.GetTable(i);
+                uint32_t run = std::min(remaining, table.mCount);
+                layout.mTypes[column].DestructValues(table.GetColumn(column), run);
+                remaining -= run;
+            }
+        }
+        archetype.RemoveTail(archetype.Size(), false);
+        throw;
+    }
+    return in;
+}
+
+inline void WorldSnapshot::Load(World& world, const std::vector<uint8_t>& in)
+{
+    Load(world, in.data(), in.size());
+}
+
+inline void WorldSnapshot::Require(const uint8_t* in, const uint8_t* end, size_t size)
+{
+    if (static_cast<size_t>(end - in) < size)
+        throw std::runtime_error("Invalid snapshot - unexpected end of data");
+}
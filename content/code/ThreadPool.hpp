@@ -0,0 +1,280 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @author Will Bender
+ *
+ ** Work-stealing thread pool.
+ */
+
+/*
+ ** Pool of worker threads, each owning a task queue.
+ *
+ * Workers pop tasks from the back of their own queue and steal from the front of other queues when empty. The thread
+ * that created the pool owns queue 0, and only runs tasks while waiting on a counter (see `Wait`), so a pool of N
+ * workers starts N - 1 threads.
+ *
+ * Completion is tracked with counters: every task may reference an atomic counter that is decremented once the task
+ * finishes, even if it throws. The first exception thrown by the tasks of a counter is rethrown by `Wait`.
+ */
+class ThreadPool
+{
+public:
+    using Counter = std::atomic<uint32_t>;
+
+    /**
+     * Create a pool
+     * @param workers Number of workers including the calling thread, 0 uses the hardware concurrency
+     */
+    explicit ThreadPool(uint32_t workers = 0);
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+    ~ThreadPool();
+
+    /**
+     * Queue a task on the current worker, or queue 0 when called from outside the pool
+     * @param task Task to run
+     * @param counter Counter decremented once the task finishes, must be incremented by the caller beforehand
+     */
+    void Submit(std::function<void()> task, Counter* counter = nullptr);
+    /**
+     * Run queued tasks until a counter reaches zero, then rethrow the first exception thrown by its tasks. Exceptions
+     * of tasks submitted without a counter are rethrown by the next `Wait` to finish.
+     * @param counter Counter to wait on
+     */
+    void Wait(const Counter& counter);
+    /**
+     * Split a range into chunks and run them in parallel, returning once all chunks finish
+     * @param count Size of the range
+     * @param grain Maximum size of a chunk
+     * @param function Called as `function(uint32_t begin, uint32_t end)`
+     */
+    template<typename F>
+    void ParallelFor(uint32_t count, uint32_t grain, F&& function);
+
+    // Number of workers, including the thread that created the pool
+    uint32_t WorkerCount() const;
+
+private:
+    struct Task
+    {
+        std::function<void()> mFunction;
+        Counter* mCounter;
+    };
+
+    struct Queue
+    {
+        std::mutex mMutex;
+        std::deque<Task> mTasks;
+    };
+
+    uint32_t GetWorker() const;
+    bool TryRun(uint32_t worker);
+    // Remove the exceptions thrown by tasks of a counter, or without a counter, returning the first
+    std::exception_ptr TakeError(const Counter& counter);
+    void WorkerLoop(uint32_t worker);
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::atomic<uint32_t> mPending;
+    std::atomic<bool> mStop;
+    std::mutex mSleepMutex;
+    std::condition_variable mWake;
+
+    std::mutex mErrorMutex;
+    std::vector<std::pair<const Counter*, std::exception_ptr>> mErrors;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename F>
+void ThreadPool::ParallelFor(uint32_t count, uint32_t grain, F&& function)
+{
+    grain = std::max(grain, 1u);
+    uint32_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1)
+    {
+        if (count != 0)
+            function(0u, count);
+        return;
+    }
+
+    Counter counter(chunks);
+    for (uint32_t begin = 0; begin < count; begin += grain)
+    {
+        uint32_t end = std::min(count, begin + grain);
+        Submit([&function, begin, end] { function(begin, end); }, &counter);
+    }
+    Wait(counter);
+}
+
+///////////////////////////////////
+/// Implementations
+
+namespace ThreadPoolDetail
+{
+    // Pool and queue owned by the current thread
+    inline thread_local const ThreadPool* tPool = nullptr;
+    inline thread_local uint32_t tWorker = 0;
+}
+
+inline ThreadPool::ThreadPool(uint32_t workers) : mPending(0), mStop(false)
+{
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    for (uint32_t i = 0; i < workers; ++i)
+        mQueues.push_back(std::make_unique<Queue>());
+    for (uint32_t i = 1; i < workers; ++i)
+        mThreads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(mSleepMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+
+    for (std::thread& thread : mThreads)
+        thread.join();
+}
+
+inline void ThreadPool::Submit(std::function<void()> task, Counter* counter)
+{
+    Queue& queue = *mQueues[GetWorker()];
+    {
+        std::lock_guard lock(queue.mMutex);
+        queue.mTasks.push_back(Task{std::move(task), counter});
+    }
+    mPending.fetch_add(1);
+
+    // Synchronize with sleeping workers so the wake up can not be missed
+    {
+        std::lock_guard lock(mSleepMutex);
+    }
+    mWake.notify_one();
+}
+
+inline void ThreadPool::Wait(const Counter& counter)
+{
+    uint32_t worker = GetWorker();
+    while (counter.load(std::memory_order_acquire) != 0)
+    {
+        if (!TryRun(worker))
+            std::this_thread::yield();
+    }
+
+    if (std::exception_ptr error = TakeError(counter))
+        std::rethrow_exception(error);
+}
+
+inline uint32_t ThreadPool::WorkerCount() const
+{
+    return static_cast<uint32_t>(mQueues.size());
+}
+
+inline uint32_t ThreadPool::GetWorker() const
+{
+    return ThreadPoolDetail::tPool == this ? ThreadPoolDetail::tWorker : 0;
+}
+
+inline bool ThreadPool::TryRun(uint32_t worker)
+{
+    Task task;
+    bool found = false;
+
+    // Own queue first, newest task for locality
+    {
+        Queue& queue = *mQueues[worker];
+        std::lock_guard lock(queue.mMutex);
+        if (!queue.mTasks.empty())
+        {
+            task = std::move(queue.mTasks.back());
+            queue.mTasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Steal the oldest task of another worker
+    for (uint32_t i = 1; !found && i < mQueues.size(); ++i)
+    {
+        Queue& queue = *mQueues[(worker + i) % mQueues.size()];
+        std::lock_guard lock(queue.mMutex);
+        if (!queue.mTasks.empty())
+        {
+            task = std::move(queue.mTasks.front());
+            queue.mTasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    mPending.fetch_sub(1);
+    try
+    {
+        task.mFunction();
+    }
+    catch (...)
+    {
+        // Stored before the counter is released, so the waiting thread sees it
+        std::lock_guard lock(mErrorMutex);
+        mErrors.emplace_back(task.mCounter, std::current_exception());
+    }
+    if (task.mCounter)
+        task.mCounter->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+inline std::exception_ptr ThreadPool::TakeError(const Counter& counter)
+{
+    std::lock_guard lock(mErrorMutex);
+    std::exception_ptr out;
+    auto matches = [&counter](const std::pair<const Counter*, std::exception_ptr>& error)
+    {
+        return error.first == &counter || error.first == nullptr;
+    };
+    for (const auto& error : mErrors)
+    {
+        if (matches(error))
+        {
+            out = error.second;
+            break;
+        }
+    }
+    mErrors.erase(std::remove_if(mErrors.begin(), mErrors.end(), matches), mErrors.end());
+    return out;
+}
+
+inline void ThreadPool::WorkerLoop(uint32_t worker)
+{
+    ThreadPoolDetail::tPool = this;
+    ThreadPoolDetail::tWorker = worker;
+
+    while (true)
+    {
+        if (TryRun(worker))
+            continue;
+
+        std::unique_lock lock(mSleepMutex);
+        mWake.wait(lock, [this] { return mStop || mPending.load() != 0; });
+        if (mStop)
+            return;
+    }
+}
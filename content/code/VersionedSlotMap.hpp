@@ -0,0 +1,293 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Slotmap.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** SlotMap variant with copy-on-write snapshots.
+ */
+
+/*
+ ** SlotMap whose contents can be captured as an immutable version in O(1).
+ *
+ * Nodes are stored in fixed size pages held by `shared_ptr`, and the page table itself is shared. `Snapshot` only
+ * copies the pointer to the page table. The next write clones the page table (one pointer per page) and then each
+ * page it touches while the page is still shared, so the cost of a snapshot scales with the pages modified while it
+ * is alive rather than with the size of the map. Copying the map shares pages the same way.
+ *
+ * Versions are immutable and may be read and destroyed on any thread. The map itself, including `Snapshot`, must only
+ * be used by one thread at a time. Values must be copy constructible.
+ *
+ * @tparam Value Value type
+ */
+template<typename Value>
+class VersionedSlotMap
+{
+    struct Node
+    {
+        std::optional<Value> mValue;
+        uint32_t mGeneration = 0;
+        uint32_t mNextFree = UINT32_MAX;
+    };
+
+public:
+    using Key = SlotKey<uint32_t, uint32_t>;
+
+    // Nodes per page, the granularity of copy-on-write
+    static constexpr uint32_t PageSize = 256;
+
+private:
+    using Page = std::array<Node, PageSize>;
+    // Pages are only shared as const, the map writes to pages it holds the only reference to
+    using PageTable = std::vector<std::shared_ptr<const Page>>;
+
+public:
+    /*
+     ** Immutable view of the map at the time `Snapshot` was called.
+     */
+    class Version
+    {
+    public:
+        Version() = default;
+
+        /**
+         * Find a value
+         * @param key Key of the value
+         * @return Value, or nullptr if the key was not present when the version was taken
+         */
+        const Value* Find(Key key) const;
+        /**
+         * Call a function on every value
+         * @param function Called as `function(Key key, const Value& value)`
+         */
+        template<typename F>
+        void ForEach(F&& function) const;
+
+        uint32_t Size() const;
+
+    private:
+        friend VersionedSlotMap;
+
+        std::shared_ptr<const PageTable> mPages;
+        uint32_t mNodeCount = 0;
+        uint32_t mSize = 0;
+    };
+
+    VersionedSlotMap();
+
+    /**
+     * Insert a value
+     * @param value Value to insert
+     * @return Key referring to the value
+     */
+    Key Insert(Value value);
+    /**
+     * Remove a value
+     * @param key Key of the value
+     * @return False if the key was already removed
+     */
+    bool Remove(Key key);
+    /**
+     * Find a value for writing, copying its page if a version still shares it
+     * @param key Key of the value
+     * @return Value, or nullptr if the key was removed
+     */
+    Value* Find(Key key);
+    const Value* Find(Key key) const;
+    /**
+     * Call a function on every value without copying pages
+     * @param function Called as `function(Key key, const Value& value)`
+     */
+    template<typename F>
+    void ForEach(F&& function) const;
+
+    /**
+     * Capture the current contents
+     * @return Immutable version sharing every page with the map
+     */
+    Version Snapshot() const;
+
+    uint32_t Size() const;
+
+private:
+    template<typename F>
+    static void ForEachNode(const PageTable& pages, uint32_t count, F&& function);
+    static const Node* FindNode(const PageTable& pages, uint32_t count, Key key);
+
+    PageTable& WritePages();
+    Node& WriteNode(uint32_t index);
+
+    std::shared_ptr<PageTable> mPages;
+    uint32_t mNodeCount;
+    uint32_t mFreeList;
+    uint32_t mSize;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename Value>
+VersionedSlotMap<Value>::VersionedSlotMap() :
+    mPages(std::make_shared<PageTable>()), mNodeCount(0), mFreeList(UINT32_MAX), mSize(0)
+{
+}
+
+template<typename Value>
+typename VersionedSlotMap<Value>::Key VersionedSlotMap<Value>::Insert(Value value)
+{
+    uint32_t index;
+    if (mFreeList != UINT32_MAX)
+    {
+        index = mFreeList;
+        mFreeList = WriteNode(index).mNextFree;
+    }
+    else
+    {
+        index = mNodeCount++;
+        if (index % PageSize == 0)
+            WritePages().push_back(std::make_shared<Page>());
+    }
+
+    Node& node = WriteNode(index);
+    node.mValue.emplace(std::move(value));
+    ++mSize;
+    return Key(node.mGeneration, index);
+}
+
+template<typename Value>
+bool VersionedSlotMap<Value>::Remove(Key key)
+{
+    // Validate against the shared pages first, so invalid keys never copy a page
+    if (!FindNode(*mPages, mNodeCount, key))
+        return false;
+
+    Node& node = WriteNode(key.mIndex);
+    node.mValue.reset();
+    ++node.mGeneration;
+    node.mNextFree = mFreeList;
+    mFreeList = key.mIndex;
+    --mSize;
+    return true;
+}
+
+template<typename Value>
+Value* VersionedSlotMap<Value>::Find(Key key)
+{
+    if (!FindNode(*mPages, mNodeCount, key))
+        return nullptr;
+    return &*WriteNode(key.mIndex).mValue;
+}
+
+template<typename Value>
+const Value* VersionedSlotMap<Value>::Find(Key key) const
+{
+    const Node* node = FindNode(*mPages, mNodeCount, key);
+    return node ? &*node->mValue : nullptr;
+}
+
+template<typename Value>
+template<typename F>
+void VersionedSlotMap<Value>::ForEach(F&& function) const
+{
+    ForEachNode(*mPages, mNodeCount, std::forward<F>(function));
+}
+
+template<typename Value>
+typename VersionedSlotMap<Value>::Version VersionedSlotMap<Value>::Snapshot() const
+{
+    Version out;
+    out.mPages = mPages;
+    out.mNodeCount = mNodeCount;
+    out.mSize = mSize;
+    return out;
+}
+
+template<typename Value>
+uint32_t VersionedSlotMap<Value>::Size() const
+{
+    return mSize;
+}
+
+template<typename Value>
+template<typename F>
+void VersionedSlotMap<Value>::ForEachNode(const PageTable& pages, uint32_t count, F&& function)
+{
+    for (uint32_t page = 0; page * PageSize < count; ++page)
+    {
+        const Page& nodes = *pages[page];
+        uint32_t end = std::min(PageSize, count - page * PageSize);
+        for (uint32_t i = 0; i < end; ++i)
+        {
+            if (nodes[i].mValue)
+                function(Key(nodes[i].mGeneration, page * PageSize + i), *nodes[i].mValue);
+        }
+    }
+}
+
+template<typename Value>
+const typename VersionedSlotMap<Value>::Node* VersionedSlotMap<Value>::FindNode(const PageTable& pages, uint32_t count,
+                                                                                Key key)
+{
+    if (key.mIndex >= count)
+        return nullptr;
+
+    const Node& node = (*pages[key.mIndex / PageSize])[key.mIndex % PageSize];
+    if (!node.mValue || node.mGeneration != key.mGeneration)
+        return nullptr;
+    return &node;
+}
+
+template<typename Value>
+typename VersionedSlotMap<Value>::PageTable& VersionedSlotMap<Value>::WritePages()
+{
+    if (mPages.use_count() > 1)
+        mPages = std::make_shared<PageTable>(*mPages);
+
+    // Synchronize with versions released on other threads before writing in place
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return *mPages;
+}
+
+template<typename Value>
+typename VersionedSlotMap<Value>::Node& VersionedSlotMap<Value>::WriteNode(uint32_t index)
+{
+    std::shared_ptr<const Page>& page = WritePages()[index / PageSize];
+    if (page.use_count() > 1)
+        page = std::make_shared<Page>(*page);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Pages are created non-const, a page referenced once is owned by this map
+    return const_cast<Page&>(*page)[index % PageSize];
+}
+
+template<typename Value>
+const Value* VersionedSlotMap<Value>::Version::Find(Key key) const
+{
+    if (!mPages)
+        return nullptr;
+    const Node* node = FindNode(*mPages, mNodeCount, key);
+    return node ? &*node->mValue : nullptr;
+}
+
+template<typename Value>
+template<typename F>
+void VersionedSlotMap<Value>::Version::ForEach(F&& function) const
+{
+    if (mPages)
+        ForEachNode(*mPages, mNodeCount, std::forward<F>(function));
+}
+
+template<typename Value>
+uint32_t VersionedSlotMap<Value>::Version::Size() const
+{
+    return mSize;
+}
@@ -0,0 +1,900 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Archetype.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @author Will Bender
+ *
+ ** ECS world, owning the entity provider and every archetype.
+ *
+ * Entity -> Archetype Entity -> Archetype -> Table -> Components
+ */
+
+///////////////////////////////////
+/// Query Definitions
+
+/*
+ ** Marks a query component as optional.
+ * Entities without the component still match, and receive nullptr for it.
+ */
+template<typename T>
+struct Opt {};
+
+/*
+ ** Describes how a component is requested by a query.
+ *
+ * - `T`: Required, mutable
+ * - `const T`: Required, read only
+ * - `Opt<T>`: Optional
+ */
+template<typename T>
+struct QueryTraits
+{
+    using Component = std::remove_cv_t<T>;
+    using Pointer = T*;
+    using Reference = T&;
+    static constexpr bool Optional = false;
+    static constexpr bool ReadOnly = std::is_const_v<T>;
+};
+
+template<typename T>
+struct QueryTraits<Opt<T>>
+{
+    using Component = std::remove_cv_t<T>;
+    using Pointer = T*;
+    using Reference = T*;
+    static constexpr bool Optional = true;
+    static constexpr bool ReadOnly = std::is_const_v<T>;
+};
+
+class World;
+
+/*
+ ** View of every entity matching a set of components.
+ *
+ * Views are persistent queries. Matching archetypes and the byte offset of each requested column (or its absence, for
+ * optional components) are cached, and only archetypes created since the last call are matched before iterating.
+ * Archetypes are never destroyed, so a view stays valid for the lifetime of its world, and keeping one avoids
+ * re-matching every archetype per frame. Iteration walks each table as raw column pointers, with no per-entity checks.
+ *
+ * A view must not be used from multiple threads at once, though the functions passed to parallel iteration are.
+ *
+ * Iterating mutable components with `ZoneTraits` invalidates their zone summaries in every visited table. Request them
+ * as `const T` where possible so filtered queries keep skipping tables.
+ *
+ * @tparam Ts Requested components, see `QueryTraits`
+ */
+template<typename... Ts>
+class View
+{
+public:
+    /**
+     * Create a view over a world, matching every existing archetype
+     * @param world World to query
+     */
+    explicit View(World& world);
+
+    /**
+     * Match archetypes created since the last refresh. Called by every iteration function.
+     */
+    void Refresh() const;
+
+    /**
+     * Call a function for every table containing matching entities
+     * @param function Called as `function(uint32_t count, const EntityKey* entities, Ts* columns...)`.
+     *                 Columns of missing optional components are nullptr.
+     */
+    template<typename F>
+    void ForEachTable(F&& function);
+    /**
+     * Call a function for every matching entity
+     * @param function Called as `function(Ts&... components)`, optional components are passed as pointers.
+     */
+    template<typename F>
+    void ForEach(F&& function);
+    /**
+     * Call a function for every matching entity, including its entity reference
+     * @param function Called as `function(Entity entity, Ts&... components)`
+     */
+    template<typename F>
+    void ForEachEntity(F&& function);
+
+    /**
+     * Call a function for every table containing matching entities, splitting the tables into chunks run in parallel
+     * @param pool Pool running the chunks
+     * @param function See `ForEachTable`, called concurrently from multiple threads
+     * @param grain Number of tables per chunk
+     */
+    template<typename F>
+    void ParallelForEachTable(ThreadPool& pool, F&& function, uint32_t grain = 1);
+    /**
+     * Call a function for every matching entity, splitting the tables into chunks run in parallel
+     * @param pool Pool running the chunks
+     * @param function See `ForEach`, called concurrently from multiple threads
+     * @param grain Number of tables per chunk
+     */
+    template<typename F>
+    void ParallelForEach(ThreadPool& pool, F&& function, uint32_t grain = 1);
+
+    /**
+     * Call a function for every table whose zone summary of a component may contain matching values. Stale summaries
+     * are rebuilt first, tables are skipped without touching their columns.
+     * @tparam T Required component of the view with `ZoneTraits`
+     * @param mayMatch Called as `bool mayMatch(const ZoneTraits<T>::Summary& summary)`, false skips the table
+     * @param function See `ForEachTable`
+     */
+    template<typename T, typename P, typename F>
+    void ForEachTableWhere(P&& mayMatch, F&& function);
+    /**
+     * Call a function for every matching entity whose component passes a filter, skipping tables with zone summaries
+     * @tparam T Required component of the view with `ZoneTraits`
+     * @param mayMatch See `ForEachTableWhere`
+     * @param matches Called as `bool matches(const T& value)` for each row of tables that were not skipped
+     * @param function See `ForEach`
+     */
+    template<typename T, typename P, typename R, typename F>
+    void ForEachWhere(P&& mayMatch, R&& matches, F&& function);
+
+    // Number of matching entities
+    uint32_t Size() const;
+    World& GetWorld() const;
+    // ID of the viewed world, still valid after the world is destroyed, see `World::GetId`
+    uint64_t GetWorldId() const;
+
+private:
+    // Offset of a missing optional column
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+    struct Match
+    {
+        Archetype* mArchetype;
+        // Column of each requested component, for zone summaries
+        std::array<uint32_t, sizeof...(Ts)> mColumns;
+        // Byte offset of each requested column within a table
+        std::array<uint32_t, sizeof...(Ts)> mOffsets;
+    };
+
+    // Index of a required component within `Ts`, or `sizeof...(Ts)`
+    template<typename T>
+    static constexpr size_t IndexOf();
+    // Invalidate the zone summary of a mutable component before handing out its column
+    template<typename T>
+    static void InvalidateZone(const Table& table, uint32_t column);
+
+    template<typename F, size_t... Is>
+    static void InvokeTable(F& function, const Match& match, const Table& table, std::index_sequence<Is...>);
+    // Adapts a per-entity function into a per-table function
+    template<bool WithEntity, typename F>
+    static auto RowFunction(F& function);
+    template<typename T>
+    static typename QueryTraits<T>::Reference GetRow(typename QueryTraits<T>::Pointer column, uint32_t row);
+
+    World* mWorld;
+    uint64_t mWorldId;
+    // Sorted required components
+    std::vector<ComponentId> mRequired;
+    // Number of archetypes already matched
+    mutable uint32_t mArchetypeCount;
+    mutable std::vector<Match> mMatches;
+};
+
+///////////////////////////////////
+/// World Definitions
+
+/*
+ ** Owns all entities and their components.
+ */
+class World
+{
+public:
+    World();
+    World(const World& other) = delete;
+    World& operator=(const World& other) = delete;
+
+    /**
+     * Create an entity with the given components
+     * @param components Components, each type may appear once
+     * @return Entity reference
+     */
+    template<typename... Ts>
+    Entity Spawn(Ts&&... components);
+    /**
+     * Destroy an entity and all its components
+     * @param entity Entity to destroy
+     */
+    void Despawn(Entity entity);
+    /**
+     * Check if an entity exists
+     * @param entity Entity reference
+     * @return Alive
+     */
+    bool IsAlive(Entity entity);
+
+    /**
+     * Add a component to an entity, replacing it if the entity already has one. Replacing widens the zone summary
+     * of `T` rather than invalidating it, so prefer it over writing through `Get` for zoned components.
+     * @param entity Entity to modify
+     * @param component Component value
+     * @return Reference to the stored component, writes through it must not change zoned components
+     */
+    template<typename T>
+    std::decay_t<T>& Add(Entity entity, T&& component);
+    /**
+     * Remove a component from an entity, does nothing if the entity does not have it
+     * @param entity Entity to modify
+     */
+    template<typename T>
+    void Remove(Entity entity);
+    /**
+     * Add a component to many entities. Entities are grouped by archetype and moved between tables in runs.
+     * Entities that already have the component have it replaced.
+     * @param entities Entities to modify
+     * @param component Value copied into every entity
+     */
+    template<typename T>
+    void Add(const std::vector<Entity>& entities, const T& component);
+    /**
+     * Remove a component from many entities. Entities are grouped by archetype and moved between tables in runs.
+     * @param entities Entities to modify
+     */
+    template<typename T>
+    void Remove(const std::vector<Entity>& entities);
+
+    /**
+     * Access a component of an entity. Invalidates the zone summary of `T` in the entity's table, see `ZoneTraits`.
+     * @param entity Entity reference
+     * @return Component, or nullptr if the entity does not have it
+     */
+    template<typename T>
+    T* Get(Entity entity);
+    template<typename T>
+    bool Has(Entity entity);
+
+    /**
+     * Create a view of all entities matching a set of components. Keep the view between frames to only match
+     * archetypes created in the meantime.
+     * @tparam Ts Requested components, see `QueryTraits`
+     * @return View
+     */
+    template<typename... Ts>
+    View<Ts...> Query();
+
+    /**
+     * Find or create the archetype storing exactly the given components
+     * @param components Sorted, unique component IDs
+     * @return Archetype
+     */
+    Archetype& GetArchetype(const std::vector<ComponentId>& components);
+    Archetype& GetArchetype(uint32_t index);
+    uint32_t ArchetypeCount() const;
+
+    EntityProvider& GetEntities();
+    // Number of living entities
+    uint32_t Size() const;
+    // Unique ID of the world, never reused within a process even if another world takes its address
+    uint64_t GetId() const;
+
+private:
+    struct ComponentSetHasher
+    {
+        std::size_t operator()(const std::vector<ComponentId>& components) const;
+    };
+
+    ArchetypeEntity& Locate(Entity entity);
+    // Archetype reached by adding a component, cached on the source archetype
+    Archetype& GetAddTarget(Archetype& source, ComponentId component);
+    // Archetype reached by removing a component, cached on the source archetype
+    Archetype& GetRemoveTarget(Archetype& source, ComponentId component);
+    /**
+     * Move a set of entities from one archetype to another. Rows are first swapped to the end of the source
+     * archetype, then moved in runs with `Archetype::MoveTail`.
+     * @param rows Archetype wide rows of the entities within the source archetype, sorted and unique
+     * @return Archetype wide row of the first moved entity within the destination
+     */
+    uint32_t MoveBatch(Archetype& source, Archetype& destination, const std::vector<uint32_t>& rows);
+    /**
+     * Swap rows to the end of an archetype, updating the locations of every entity moved
+     * @param rows Archetype wide rows, sorted and unique
+     */
+    void SwapToTail(Archetype& archetype, const std::vector<uint32_t>& rows);
+    // Update the location of every entity in a range of archetype wide rows
+    void UpdateLocations(Archetype& archetype, uint32_t first, uint32_t count);
+    /**
+     * Group entities by archetype, calling `function(Archetype& source, std::vector<uint32_t>& rows)` per group
+     */
+    template<typename F>
+    void ForEachArchetypeGroup(const std::vector<Entity>& entities, F&& function);
+    /**
+     * Move an entity into another archetype. Shared components are relocated, components missing in the
+     * destination are destructed, and components missing in the source are left uninitialized.
+     */
+    ArchetypeEntity& Move(Entity entity, Archetype& destination);
+
+    static uint64_t NextId();
+
+    friend class CommandQueue;
+    friend class WorldSnapshot;
+
+    uint64_t mId;
+    std::vector<std::unique_ptr<Archetype>> mArchetypes;
+    std::unordered_map<std::vector<ComponentId>, uint32_t, ComponentSetHasher> mArchetypeLookup;
+    EntityProvider mEntities;
+};
+
+///////////////////////////////////
+/// Template Implementations
+
+template<typename... Ts>
+View<Ts...>::View(World& world) : mWorld(&world), mWorldId(world.GetId()), mArchetypeCount(0)
+{
+    ((QueryTraits<Ts>::Optional
+          ? void()
+          : mRequired.push_back(MetaTypeRegistry::GetId<typename QueryTraits<Ts>::Component>())), ...);
+    std::sort(mRequired.begin(), mRequired.end());
+
+    Refresh();
+}
+
+template<typename... Ts>
+void View<Ts...>::Refresh() const
+{
+    uint32_t count = mWorld->ArchetypeCount();
+    if (mArchetypeCount == count)
+        return;
+
+    std::array<ComponentId, sizeof...(Ts)> components = {
+        MetaTypeRegistry::GetId<typename QueryTraits<Ts>::Component>()...};
+
+    for (uint32_t i = mArchetypeCount; i < count; ++i)
+    {
+        Archetype& archetype = mWorld->GetArchetype(i);
+        if (!archetype.Contains(mRequired))
+            continue;
+
+        Match match{&archetype, {}, {}};
+        for (size_t j = 0; j < components.size(); ++j)
+        {
+            uint32_t column = archetype.GetColumn(components[j]);
+            match.mColumns[j] = column;
+            match.mOffsets[j] = column == Archetype::InvalidColumn
+                ? InvalidOffset
+                : archetype.GetLayout().mOffsets[column];
+        }
+        mMatches.push_back(match);
+    }
+    mArchetypeCount = count;
+}
+
+template<typename... Ts>
+template<typename F>
+void View<Ts...>::ForEachTable(F&& function)
+{
+    Refresh();
+    for (const Match& match : mMatches)
+    {
+        uint32_t tables = match.mArchetype->TableCount();
+        for (uint32_t i = 0; i < tables; ++i)
+            InvokeTable(function, match, match.mArchetype->GetTable(i), std::index_sequence_for<Ts...>());
+    }
+}
+
+template<typename... Ts>
+template<typename F>
+void View<Ts...>::ForEach(F&& function)
+{
+    ForEachTable(RowFunction<false>(function));
+}
+
+template<typename... Ts>
+template<typename F>
+void View<Ts...>::ForEachEntity(F&& function)
+{
+    ForEachTable(RowFunction<true>(function));
+}
+
+template<typename... Ts>
+template<typename F>
+void View<Ts...>::ParallelForEachTable(ThreadPool& pool, F&& function, uint32_t grain)
+{
+    Refresh();
+
+    // Flatten tables so chunks can span archetypes
+    std::vector<std::pair<const Match*, uint32_t>> tables;
+    for (const Match& match : mMatches)
+    {
+        uint32_t count = match.mArchetype->TableCount();
+        for (uint32_t i = 0; i < count; ++i)
+            tables.emplace_back(&match, i);
+    }
+
+    pool.ParallelFor(static_cast<uint32_t>(tables.size()), grain, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const Match& match = *tables[i].first;
+            InvokeTable(function, match, match.mArchetype->GetTable(tables[i].second), std::index_sequence_for<Ts...>());
+        }
+    });
+}
+
+template<typename... Ts>
+template<typename F>
+void View<Ts...>::ParallelForEach(ThreadPool& pool, F&& function, uint32_t grain)
+{
+    ParallelForEachTable(pool, RowFunction<false>(function), grain);
+}
+
+template<typename... Ts>
+template<typename T, typename P, typename F>
+void View<Ts...>::ForEachTableWhere(P&& mayMatch, F&& function)
+{
+    constexpr size_t index = IndexOf<T>();
+    static_assert(index < sizeof...(Ts), "Filtered component must be a required component of the view");
+    static_assert(HasZoneTraits<T>::value, "Filtered component must specialize ZoneTraits");
+    using Summary = typename ZoneTraits<T>::Summary;
+
+    Refresh();
+    for (const Match& match : mMatches)
+    {
+        uint32_t tables = match.mArchetype->TableCount();
+        for (uint32_t i = 0; i < tables; ++i)
+        {
+            const Table& table = match.mArchetype->GetTable(i);
+            const void* zone = table.GetZone(match.mColumns[index]);
+            if (zone && !mayMatch(*static_cast<const Summary*>(zone)))
+                continue;
+            InvokeTable(function, match, table, std::index_sequence_for<Ts...>());
+        }
+    }
+}
+
+template<typename... Ts>
+template<typename T, typename P, typename R, typename F>
+void View<Ts...>::ForEachWhere(P&& mayMatch, R&& matches, F&& function)
+{
+    constexpr size_t index = IndexOf<T>();
+    ForEachTableWhere<T>(mayMatch,
+        [&](uint32_t count, const EntityKey*, typename QueryTraits<Ts>::Pointer... columns)
+        {
+            const T* values = std::get<index>(std::make_tuple(columns...));
+            for (uint32_t row = 0; row < count; ++row)
+            {
+                if (matches(values[row]))
+                    function(GetRow<Ts>(columns, row)...);
+            }
+        });
+}
+
+template<typename... Ts>
+template<typename F, size_t... Is>
+void View<Ts...>::InvokeTable(F& function, const Match& match, const Table& table, std::index_sequence<Is...>)
+{
+    (InvalidateZone<Ts>(table, match.mColumns[Is]), ...);
+    function(table.mCount, static_cast<const EntityKey*>(table.GetEntities()),
+             (match.mOffsets[Is] == InvalidOffset
+                  ? nullptr
+                  : reinterpret_cast<typename QueryTraits<Ts>::Pointer>(table.mData + match.mOffsets[Is]))...);
+}
+
+template<typename... Ts>
+template<bool WithEntity, typename F>
+auto View<Ts...>::RowFunction(F& function)
+{
+    return [&function](uint32_t count, const EntityKey* entities, typename QueryTraits<Ts>::Pointer... columns)
+    {
+        for (uint32_t row = 0; row < count; ++row)
+        {
+            if constexpr (WithEntity)
+                function(Entity(entities[row]), GetRow<Ts>(columns, row)...);
+            else
+                function(GetRow<Ts>(columns, row)...);
+        }
+    };
+}
+
+template<typename... Ts>
+template<typename T>
+typename QueryTraits<T>::Reference View<Ts...>::GetRow(typename QueryTraits<T>::Pointer column, uint32_t row)
+{
+    if constexpr (QueryTraits<T>::Optional)
+        return column ? column + row : nullptr;
+    else
+        return column[row];
+}
+
+template<typename... Ts>
+template<typename T>
+constexpr size_t View<Ts...>::IndexOf()
+{
+    constexpr bool found[] = {
+        (std::is_same_v<typename QueryTraits<Ts>::Component, T> && !QueryTraits<Ts>::Optional)...};
+    for (size_t i = 0; i < sizeof...(Ts); ++i)
+    {
+        if (found[i])
+            return i;
+    }
+    return sizeof...(Ts);
+}
+
+template<typename... Ts>
+template<typename T>
+void View<Ts...>::InvalidateZone(const Table& table, uint32_t column)
+{
+    if constexpr (!QueryTraits<T>::ReadOnly && HasZoneTraits<typename QueryTraits<T>::Component>::value)
+    {
+        if (column != Archetype::InvalidColumn)
+            table.InvalidateZone(column);
+    }
+}
+
+template<typename... Ts>
+uint32_t View<Ts...>::Size() const
+{
+    Refresh();
+    uint32_t out = 0;
+    for (const Match& match : mMatches)
+        out += match.mArchetype->Size();
+    return out;
+}
+
+template<typename... Ts>
+World& View<Ts...>::GetWorld() const
+{
+    return *mWorld;
+}
+
+template<typename... Ts>
+uint64_t View<Ts...>::GetWorldId() const
+{
+    return mWorldId;
+}
+
+template<typename... Ts>
+Entity World::Spawn(Ts&&... components)
+{
+    std::vector<ComponentId> ids = {MetaTypeRegistry::GetId<std::decay_t<Ts>>()...};
+    std::sort(ids.begin(), ids.end());
+    if (std::adjacent_find(ids.begin(), ids.end()) != ids.end())
+        throw std::runtime_error("Entity spawned with duplicate components");
+
+    Archetype& archetype = GetArchetype(ids);
+
+    Entity entity = mEntities.insert(ArchetypeEntity{});
+    ArchetypeEntity location = archetype.Allocate(entity.mKey);
+    mEntities.find(entity).get() = location;
+
+    Table& table = archetype.GetTable(location.mTable);
+    (new (table.GetValue(archetype.GetColumn(MetaTypeRegistry::GetId<std::decay_t<Ts>>()), location.mRow))
+         std::decay_t<Ts>(std::forward<Ts>(components)), ...);
+
+    return entity;
+}
+
+template<typename T>
+std::decay_t<T>& World::Add(Entity entity, T&& component)
+{
+    using Component = std::decay_t<T>;
+    ComponentId id = MetaTypeRegistry::GetId<Component>();
+
+    ArchetypeEntity& current = Locate(entity);
+    Archetype& source = *mArchetypes[current.mArchetype];
+    uint32_t column = source.GetColumn(id);
+    if (column != Archetype::InvalidColumn)
+        return source.GetTable(current.mTable).Set<Component>(column, current.mRow, std::forward<T>(component));
+
+    Archetype& destination = GetAddTarget(source, id);
+    ArchetypeEntity& location = Move(entity, destination);
+
+    void* value = destination.GetTable(location.mTable).GetValue(destination.GetColumn(id), location.mRow);
+    return *new (value) Component(std::forward<T>(component));
+}
+
+template<typename T>
+void World::Remove(Entity entity)
+{
+    ComponentId id = MetaTypeRegistry::GetId<T>();
+
+    Archetype& source = *mArchetypes[Locate(entity).mArchetype];
+    if (source.GetColumn(id) == Archetype::InvalidColumn)
+        return;
+
+    Move(entity, GetRemoveTarget(source, id));
+}
+
+template<typename T>
+void World::Add(const std::vector<Entity>& entities, const T& component)
+{
+    ComponentId id = MetaTypeRegistry::GetId<T>();
+
+    ForEachArchetypeGroup(entities, [&](Archetype& source, const std::vector<uint32_t>& rows)
+    {
+        uint32_t column = source.GetColumn(id);
+        if (column != Archetype::InvalidColumn)
+        {
+            for (uint32_t row : rows)
+            {
+                ArchetypeEntity location = source.GetLocation(row);
+                source.GetTable(location.mTable).Set<T>(column, location.mRow, component);
+            }
+            return;
+        }
+
+        Archetype& destination = GetAddTarget(source, id);
+        uint32_t first = MoveBatch(source, destination, rows);
+
+        column = destination.GetColumn(id);
+        for (uint32_t row = first; row < first + rows.size(); ++row)
+        {
+            ArchetypeEntity location = destination.GetLocation(row);
+            new (destination.GetTable(location.mTable).GetValue(column, location.mRow)) T(component);
+        }
+    });
+}
+
+template<typename T>
+void World::Remove(const std::vector<Entity>& entities)
+{
+    ComponentId id = MetaTypeRegistry::GetId<T>();
+
+    ForEachArchetypeGroup(entities, [&](Archetype& source, const std::vector<uint32_t>& rows)
+    {
+        if (source.GetColumn(id) != Archetype::InvalidColumn)
+            MoveBatch(source, GetRemoveTarget(source, id), rows);
+    });
+}
+
+template<typename F>
+void World::ForEachArchetypeGroup(const std::vector<Entity>& entities, F&& function)
+{
+    // Sort by archetype, then row, so each archetype is visited once
+    std::vector<std::pair<uint32_t, uint32_t>> locations;
+    locations.reserve(entities.size());
+    for (const Entity& entity : entities)
+    {
+        ArchetypeEntity& location = Locate(entity);
+        uint32_t rows = mArchetypes[location.mArchetype]->GetLayout().mRowCount;
+        locations.emplace_back(location.mArchetype, location.mTable * rows + location.mRow);
+    }
+    std::sort(locations.begin(), locations.end());
+    locations.erase(std::unique(locations.begin(), locations.end()), locations.end());
+
+    std::vector<uint32_t> rows;
+    for (size_t i = 0; i < locations.size();)
+    {
+        uint32_t archetype = locations[i].first;
+        rows.clear();
+        for (; i < locations.size() && locations[i].first == archetype; ++i)
+            rows.push_back(locations[i].second);
+
+        function(*mArchetypes[archetype], rows);
+    }
+}
+
+template<typename T>
+T* World::Get(Entity entity)
+{
+    ArchetypeEntity& location = Locate(entity);
+    Archetype& archetype = *mArchetypes[location.mArchetype];
+
+    uint32_t column = archetype.GetColumn(MetaTypeRegistry::GetId<T>());
+    if (column == Archetype::InvalidColumn)
+        return nullptr;
+
+    const Table& table = archetype.GetTable(location.mTable);
+    if constexpr (HasZoneTraits<T>::value)
+        table.InvalidateZone(column);
+    return static_cast<T*>(table.GetValue(column, location.mRow));
+}
+
+template<typename T>
+bool World::Has(Entity entity)
+{
+    return Get<T>(entity) != nullptr;
+}
+
+template<typename... Ts>
+View<Ts...> World::Query()
+{
+    return View<Ts...>(*this);
+}
+
+///////////////////////////////////
+/// Implementations
+
+inline World::World() : mId(NextId())
+{
+}
+
+inline void World::Despawn(Entity entity)
+{
+    ArchetypeEntity& location = Locate(entity);
+
+    EntityKey moved = mArchetypes[location.mArchetype]->Remove(location.mTable, location.mRow);
+    if (moved != EntityKey())
+        mEntities.find(moved).get() = location;
+
+    mEntities.remove(entity);
+}
+
+inline bool World::IsAlive(Entity entity)
+{
+    return mEntities.contains(entity);
+}
+
+inline Archetype& World::GetArchetype(const std::vector<ComponentId>& components)
+{
+    auto found = mArchetypeLookup.find(components);
+    if (found != mArchetypeLookup.end())
+        return *mArchetypes[found->second];
+
+    uint32_t index = static_cast<uint32_t>(mArchetypes.size());
+    mArchetypes.push_back(std::make_unique<Archetype>(index, components));
+    mArchetypeLookup.emplace(components, index);
+    return *mArchetypes.back();
+}
+
+inline Archetype& World::GetArchetype(uint32_t index)
+{
+    return *mArchetypes[index];
+}
+
+inline uint32_t World::ArchetypeCount() const
+{
+    return static_cast<uint32_t>(mArchetypes.size());
+}
+
+inline EntityProvider& World::GetEntities()
+{
+    return mEntities;
+}
+
+inline uint32_t World::Size() const
+{
+    return mEntities.Size();
+}
+
+inline uint64_t World::GetId() const
+{
+    return mId;
+}
+
+inline uint64_t World::NextId()
+{
+    static std::atomic<uint64_t> id(0);
+    return id.fetch_add(1);
+}
+
+inline std::size_t World::ComponentSetHasher::operator()(const std::vector<ComponentId>& components) const
+{
+    size_t seed = components.size();
+    for (ComponentId component : components)
+        seed ^= std::hash<ComponentId>()(component) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+inline ArchetypeEntity& World::Locate(Entity entity)
+{
+    return mEntities.find(entity).get();
+}
+
+inline Archetype& World::GetAddTarget(Archetype& source, ComponentId component)
+{
+    uint32_t edge = source.GetAddEdge(component);
+    if (edge != Archetype::InvalidArchetype)
+        return *mArchetypes[edge];
+
+    std::vector<ComponentId> components = source.GetComponents();
+    components.insert(std::upper_bound(components.begin(), components.end(), component), component);
+
+    Archetype& target = GetArchetype(components);
+    source.SetAddEdge(component, target.GetIndex());
+    target.SetRemoveEdge(component, source.GetIndex());
+    return target;
+}
+
+inline Archetype& World::GetRemoveTarget(Archetype& source, ComponentId component)
+{
+    uint32_t edge = source.GetRemoveEdge(component);
+    if (edge != Archetype::InvalidArchetype)
+        return *mArchetypes[edge];
+
+    std::vector<ComponentId> components = source.GetComponents();
+    components.erase(std::lower_bound(components.begin(), components.end(), component));
+
+    Archetype& target = GetArchetype(components);
+    source.SetRemoveEdge(component, target.GetIndex());
+    target.SetAddEdge(component, source.GetIndex());
+    return target;
+}
+
+inline uint32_t World::MoveBatch(Archetype& source, Archetype& destination, const std::vector<uint32_t>& rows)
+{
+    uint32_t count = static_cast<uint32_t>(rows.size());
+    SwapToTail(source, rows);
+
+    uint32_t first = source.MoveTail(destination, count);
+    UpdateLocations(destination, first, count);
+    return first;
+}
+
+inline void World::SwapToTail(Archetype& archetype, const std::vector<uint32_t>& rows)
+{
+    uint32_t tail = archetype.Size() - static_cast<uint32_t>(rows.size());
+
+    // Swap selected rows outside the tail with unselected rows inside it. Rows are sorted, so the selected rows
+    // within the tail are at the end of `rows`.
+    size_t outside = std::lower_bound(rows.begin(), rows.end(), tail) - rows.begin();
+    size_t inside = outside;
+    uint32_t candidate = tail;
+    for (size_t i = 0; i < outside; ++i)
+    {
+        while (inside < rows.size() && rows[inside] == candidate)
+            ++inside, ++candidate;
+
+        archetype.SwapRows(rows[i], candidate);
+        UpdateLocations(archetype, rows[i], 1);
+        ++candidate;
+    }
+}
+
+inline void World::UpdateLocations(Archetype& archetype, uint32_t first, uint32_t count)
+{
+    for (uint32_t row = first; row < first + count; ++row)
+    {
+        ArchetypeEntity location = archetype.GetLocation(row);
+        mEntities.find(archetype.GetTable(location.mTable).GetEntities()[location.mRow]).get() = location;
+    }
+}
+
+inline ArchetypeEntity& World::Move(Entity entity, Archetype& destination)
+{
+    ArchetypeEntity& location = Locate(entity);
+    Archetype& source = *mArchetypes[location.mArchetype];
+    Table& sourceTable = source.GetTable(location.mTable);
+
+    ArchetypeEntity moved = destination.Allocate(entity.mKey);
+    Table& destinationTable = destination.GetTable(moved.mTable);
+
+    // Both component lists are sorted, walk them together
+    const std::vector<ComponentId>& from = source.GetComponents();
+    const std::vector<ComponentId>& to = destination.GetComponents();
+    uint32_t i = 0, j = 0;
+    while (i < from.size())
+    {
+        const MetaType& type = source.GetLayout().mTypes[i];
+        void* value = sourceTable.GetValue(i, location.mRow);
+
+        if (j < to.size() && to[j] < from[i])
+        {
+            ++j;
+        }
+        else if (j < to.size() && to[j] == from[i])
+        {
+            type.RelocateValues(value, destinationTable.GetValue(j, moved.mRow), 1);
+            ++i, ++j;
+        }
+        else
+        {
+            type.DestructValues(value, 1);
+            ++i;
+        }
+    }
+
+    EntityKey filled = source.Remove(location.mTable, location.mRow, false);
+    if (filled != EntityKey())
+        mEntities.find(filled).get() = location;
+
+    location = moved;
+    return location;
+}
@@ -0,0 +1,70 @@
+/**
+ * @author Will Bender
+ *
+ ** Archetype table layout and row operations.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "World.hpp"
+
+namespace
+{
+
+// Stricter than `TableLayout::ColumnAlignment`
+struct alignas(128) Wide
+{
+    uint64_t mValue;
+};
+
+struct Narrow
+{
+    uint8_t mValue;
+};
+
+bool Aligned(const void* pointer, uintptr_t alignment)
+{
+    return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+TEST(Archetype, OverAlignedColumns)
+{
+    World world;
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < 2000; ++i)
+        entities.push_back(world.Spawn(Wide{i}, Narrow{uint8_t(i)}));
+
+    std::vector<ComponentId> components = {MetaTypeRegistry::GetId<Wide>(), MetaTypeRegistry::GetId<Narrow>()};
+    std::sort(components.begin(), components.end());
+    Archetype& archetype = world.GetArchetype(components);
+    const TableLayout& layout = archetype.GetLayout();
+    EXPECT_EQ(layout.mAlignment, alignof(Wide));
+    EXPECT_EQ(layout.mTableSize % alignof(Wide), 0u);
+    ASSERT_GT(archetype.TableCount(), 1u);
+
+    for (uint32_t i = 0; i < entities.size(); ++i)
+    {
+        Wide* wide = world.Get<Wide>(entities[i]);
+        ASSERT_TRUE(Aligned(wide, alignof(Wide)));
+        EXPECT_EQ(wide->mValue, i);
+    }
+
+    // Swapping goes through the scratch value
+    uint32_t column = archetype.GetColumn(MetaTypeRegistry::GetId<Wide>());
+    uint32_t last = archetype.Size() - 1;
+    auto valueAt = [&](uint32_t row)
+    {
+        ArchetypeEntity location = archetype.GetLocation(row);
+        return static_cast<Wide*>(archetype.GetTable(location.mTable).GetValue(column, location.mRow))->mValue;
+    };
+    archetype.SwapRows(0, last);
+    EXPECT_EQ(valueAt(0), last);
+    EXPECT_EQ(valueAt(last), 0u);
+    archetype.SwapRows(0, last);
+}
+
+} // namespace
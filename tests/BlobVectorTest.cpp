@@ -0,0 +1,137 @@
+/**
+ * @author Will Bender
+ *
+ ** BlobVector growth, removal and self-referential pushes.
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "BlobVector.hpp"
+
+namespace
+{
+
+template<typename T>
+std::vector<T> Values(const BlobVector& vector)
+{
+    const T* data = vector.Data<T>();
+    return std::vector<T>(data, data + vector.Size());
+}
+
+BlobVector Sequence(uint32_t count)
+{
+    BlobVector vector(MetaType::GenerateType<int>());
+    for (int i = 0; i < int(count); ++i)
+        vector.PushBackCopy(&i);
+    return vector;
+}
+
+// Long enough to be heap allocated, so reading a released buffer is caught by the sanitizers
+std::string Long(char c)
+{
+    return std::string(40, c);
+}
+
+TEST(BlobVector, GrowthKeepsValuesAndAlignment)
+{
+    BlobVector vector(MetaType::GenerateType<std::string>(), BlobVector::CacheLineAlignment);
+    EXPECT_EQ(vector.GetAlignment(), BlobVector::CacheLineAlignment);
+    EXPECT_THROW(BlobVector(MetaType::GenerateType<int>(), 48), std::runtime_error);
+
+    std::vector<std::string> expected;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        expected.push_back(Long(char('a' + i % 26)) + std::to_string(i));
+        vector.PushBackCopy(&expected.back());
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(vector.Data()) % BlobVector::CacheLineAlignment, 0u);
+    }
+    EXPECT_GE(vector.Capacity(), 100u);
+    EXPECT_EQ(Values<std::string>(vector), expected);
+
+    vector.ShrinkToFit();
+    EXPECT_EQ(vector.Capacity(), 100u);
+    EXPECT_EQ(Values<std::string>(vector), expected);
+
+    BlobVector copy(vector);
+    EXPECT_EQ(Values<std::string>(copy), expected);
+}
+
+TEST(BlobVector, Erase)
+{
+    BlobVector vector = Sequence(10);
+    vector.Erase(2, 3);
+    EXPECT_EQ(Values<int>(vector), (std::vector<int>{0, 1, 5, 6, 7, 8, 9}));
+    vector.Erase(6);
+    EXPECT_EQ(Values<int>(vector), (std::vector<int>{0, 1, 5, 6, 7, 8}));
+    vector.Erase(6, 0);
+    EXPECT_EQ(vector.Size(), 6u);
+
+    // A count that wraps `index + count` around must still be rejected
+    EXPECT_THROW(vector.Erase(1, UINT32_MAX), std::runtime_error);
+    EXPECT_THROW(vector.Erase(7, 0), std::runtime_error);
+    EXPECT_EQ(vector.Size(), 6u);
+}
+
+TEST(BlobVector, SwapRemove)
+{
+    BlobVector vector = Sequence(10);
+    vector.SwapRemove(1, 2);
+    EXPECT_EQ(Values<int>(vector), (std::vector<int>{0, 8, 9, 3, 4, 5, 6, 7}));
+    vector.SwapRemove(6, 2);
+    EXPECT_EQ(Values<int>(vector), (std::vector<int>{0, 8, 9, 3, 4, 5}));
+    // The removed range overlaps the values moved into it
+    vector.SwapRemove(2, 3);
+    EXPECT_EQ(Values<int>(vector), (std::vector<int>{0, 8, 5}));
+
+    EXPECT_THROW(vector.SwapRemove(2, UINT32_MAX), std::runtime_error);
+    EXPECT_EQ(vector.Size(), 3u);
+}
+
+TEST(BlobVector, PushFromOwnBuffer)
+{
+    BlobVector vector(MetaType::GenerateType<std::string>());
+    std::string first = Long('a');
+    vector.PushBackCopy(&first);
+    while (vector.Size() < vector.Capacity())
+        vector.PushBackCopy(vector.At(0));
+
+    // Each push reallocates while the source points into the old buffer
+    uint32_t capacity = vector.Capacity();
+    vector.PushBackCopy(vector.At(0));
+    ASSERT_GT(vector.Capacity(), capacity);
+
+    capacity = vector.Capacity();
+    while (vector.Size() < capacity)
+        vector.PushBackCopy(vector.At(0));
+    vector.PushBackMove(vector.At(1));
+    ASSERT_GT(vector.Capacity(), capacity);
+
+    capacity = vector.Capacity();
+    while (vector.Size() < capacity)
+        vector.PushBackCopy(vector.At(0));
+    vector.PushBackStrided(vector.At(0), 0, 4);
+    ASSERT_GT(vector.Capacity(), capacity);
+
+    capacity = vector.Capacity();
+    while (vector.Size() < capacity)
+        vector.PushBackCopy(vector.At(0));
+    const uint32_t indices[] = {0, 2};
+    vector.PushBackGather(vector.Data(), indices, 2);
+    ASSERT_GT(vector.Capacity(), capacity);
+
+    const std::string* values = vector.Data<std::string>();
+    EXPECT_TRUE(values[1].empty());
+    for (uint32_t i = 0; i < vector.Size(); ++i)
+    {
+        if (i == 1)
+            continue;
+        EXPECT_EQ(values[i], first);
+    }
+}
+
+} // namespace
@@ -0,0 +1,257 @@
+/**
+ * @author Will Bender
+ *
+ ** Column deltas, including malformed runs.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ColumnDiff.hpp"
+
+namespace
+{
+
+// Non-trivial value with serialization hooks and no default constructor, counting its live values
+struct Label
+{
+    static inline int32_t sLive = 0;
+
+    explicit Label(std::string value) : mValue(std::move(value)) { ++sLive; }
+    Label(const Label& other) : mValue(other.mValue) { ++sLive; }
+    Label(Label&& other) noexcept : mValue(std::move(other.mValue)) { ++sLive; }
+    Label& operator=(const Label& other) = default;
+    Label& operator=(Label&& other) noexcept = default;
+    ~Label() { --sLive; }
+
+    bool operator==(const Label& other) const { return mValue == other.mValue; }
+
+    void Serialize(std::vector<uint8_t>& out) const
+    {
+        uint32_t size = static_cast<uint32_t>(mValue.size());
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&size);
+        out.insert(out.end(), bytes, bytes + sizeof(size));
+        out.insert(out.end(), mValue.begin(), mValue.end());
+    }
+
+    static const uint8_t* Deserialize(const uint8_t* in, const uint8_t* end, Label* dst)
+    {
+        uint32_t size;
+        if (end - in < static_cast<ptrdiff_t>(sizeof(size)))
+            throw std::runtime_error("Label cut short");
+        std::memcpy(&size, in, sizeof(size));
+        in += sizeof(size);
+        if (static_cast<size_t>(end - in) < size)
+            throw std::runtime_error("Label cut short");
+        new (dst) Label(std::string(reinterpret_cast<const char*>(in), size));
+        return in + size;
+    }
+
+    std::string mValue;
+};
+
+// Long enough to be heap allocated, so leaks and double frees are caught by the sanitizers
+Label LabelOf(uint32_t i)
+{
+    return Label("label with a heap allocated value " + std::to_string(i));
+}
+
+BlobVector Labels(uint32_t count, uint32_t offset = 0)
+{
+    BlobVector out(MetaType::GenerateType<Label>());
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Label label = LabelOf(i + offset);
+        out.PushBackCopy(&label);
+    }
+    return out;
+}
+
+BlobVector Ints(const std::vector<uint32_t>& values)
+{
+    BlobVector out(MetaType::GenerateType<uint32_t>());
+    out.PushBackCopy(values.data(), static_cast<uint32_t>(values.size()));
+    return out;
+}
+
+template<typename T>
+std::vector<T> Values(const BlobVector& column)
+{
+    const T* data = column.Data<T>();
+    return std::vector<T>(data, data + column.Size());
+}
+
+// Round trips a delta through its serialized form, as it would be sent over the network
+ColumnDelta Transmit(const ColumnDelta& delta)
+{
+    std::vector<uint8_t> bytes;
+    ColumnDiff::Serialize(delta, bytes);
+    ColumnDelta out;
+    EXPECT_EQ(ColumnDiff::Deserialize(bytes.data(), bytes.data() + bytes.size(), out), bytes.data() + bytes.size());
+    return out;
+}
+
+TEST(ColumnDiff, TrivialRoundTrip)
+{
+    std::vector<uint32_t> values(300);
+    for (uint32_t i = 0; i < values.size(); ++i)
+        values[i] = i;
+    BlobVector previous = Ints(values);
+
+    values[3] = 1000;
+    values[4] = 1001;
+    values[200] = 1002;
+    values.push_back(1003);
+    BlobVector next = Ints(values);
+
+    ColumnDelta delta = ColumnDiff::Diff(previous, next);
+    ASSERT_EQ(delta.mRuns.size(), 3u);
+    EXPECT_EQ(delta.mRuns[0].mStart, 3u);
+    EXPECT_EQ(delta.mRuns[0].mCount, 2u);
+    EXPECT_EQ(delta.mRuns[2].mStart, 300u);
+    EXPECT_TRUE(ColumnDiff::Diff(next, next).Empty(next.Size()));
+
+    ColumnDiff::Apply(previous, Transmit(delta));
+    EXPECT_EQ(Values<uint32_t>(previous), values);
+
+    // Shrinking drops the tail
+    values.resize(100);
+    ColumnDiff::Apply(previous, ColumnDiff::Diff(previous, Ints(values)));
+    EXPECT_EQ(Values<uint32_t>(previous), values);
+}
+
+TEST(ColumnDiff, NonTrivialRoundTrip)
+{
+    {
+        BlobVector previous = Labels(150);
+        BlobVector next = Labels(220);
+        *next.Data<Label>() = LabelOf(5000);
+        next.Data<Label>()[99] = LabelOf(5001);
+
+        // Values past the previous size are appended, without default constructing them first
+        ColumnDelta delta = ColumnDiff::Diff(previous, next);
+        ColumnDiff::Apply(previous, Transmit(delta));
+        ASSERT_EQ(previous.Size(), next.Size());
+        EXPECT_TRUE(previous.GetType().mEquals(previous.Data(), next.Data(), next.Size()));
+
+        next.PopBack(70);
+        ColumnDiff::Apply(previous, ColumnDiff::Diff(previous, next));
+        ASSERT_EQ(previous.Size(), 150u);
+        EXPECT_TRUE(previous.GetType().mEquals(previous.Data(), next.Data(), next.Size()));
+    }
+    EXPECT_EQ(Label::sLive, 0);
+}
+
+TEST(ColumnDiff, TruncatedValuesKeepColumnInitialized)
+{
+    {
+        BlobVector previous = Labels(10);
+        BlobVector next = Labels(14, 100);
+        ColumnDelta delta = ColumnDiff::Diff(previous, next);
+
+        // Cut while appending, while replacing, and before the first value
+        for (size_t cut : {delta.mData.size() - 1, delta.mData.size() / 2, size_t(1)})
+        {
+            BlobVector column = Labels(10);
+            ColumnDelta truncated = delta;
+            truncated.mData.resize(cut);
+            EXPECT_THROW(ColumnDiff::Apply(column, truncated), std::runtime_error);
+
+            // Every value is either old or new, none is left destructed or constructed twice
+            for (uint32_t i = 0; i < column.Size(); ++i)
+            {
+                const Label& label = column.Data<Label>()[i];
+                EXPECT_TRUE(label == LabelOf(i) || label == LabelOf(i + 100)) << i;
+            }
+        }
+    }
+    EXPECT_EQ(Label::sLive, 0);
+}
+
+TEST(ColumnDiff, MalformedRunsAreRejected)
+{
+    std::vector<uint32_t> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    ColumnDelta valid = ColumnDiff::Diff(Ints(values), Ints({1, 2, 3, 4, 50, 60, 7, 8, 9, 10, 11, 12}));
+
+    auto withRuns = [&](uint32_t count, std::vector<ColumnDelta::Run> runs)
+    {
+        ColumnDelta delta = valid;
+        delta.mCount = count;
+        delta.mRuns = std::move(runs);
+        return delta;
+    };
+    std::vector<ColumnDelta> malformed = {
+        // `mStart + mCount` wraps around below the count
+        withRuns(12, {{4, 2}, {10, UINT32_MAX - 5}}),
+        withRuns(12, {{UINT32_MAX, 2}}),
+        // Past the end
+        withRuns(12, {{4, 2}, {10, 3}}),
+        // Overlapping
+        withRuns(12, {{4, 2}, {5, 2}}),
+        // Grown without values for index 10
+        withRuns(12, {{4, 2}, {11, 1}}),
+        withRuns(12, {{4, 2}}),
+    };
+
+    for (const ColumnDelta& delta : malformed)
+    {
+        BlobVector column = Ints(values);
+        EXPECT_THROW(ColumnDiff::Apply(column, delta), std::runtime_error);
+        EXPECT_EQ(Values<uint32_t>(column), values);
+    }
+
+    // Images reject a wrapped run, whose few bytes of data would be written far past the image
+    std::vector<uint8_t> image(12);
+    EXPECT_THROW(ColumnDiff::ApplyImage(image, withRuns(12, {{UINT32_MAX, 2}})), std::runtime_error);
+
+    BlobVector column = Ints(values);
+    ColumnDiff::Apply(column, valid);
+    EXPECT_EQ(Values<uint32_t>(column), (std::vector<uint32_t>{1, 2, 3, 4, 50, 60, 7, 8, 9, 10, 11, 12}));
+
+    // Truncated serialized deltas
+    std::vector<uint8_t> bytes;
+    ColumnDiff::Serialize(valid, bytes);
+    for (size_t size = 0; size < bytes.size(); ++size)
+    {
+        ColumnDelta delta;
+        EXPECT_THROW(ColumnDiff::Deserialize(bytes.data(), bytes.data() + size, delta), std::runtime_error);
+    }
+}
+
+TEST(ColumnDiff, Images)
+{
+    std::vector<uint8_t> previous(1000), next;
+    for (size_t i = 0; i < previous.size(); ++i)
+        previous[i] = uint8_t(i * 7);
+    next = previous;
+    next[10] ^= 1;
+    next[700] ^= 1;
+    next.resize(1100, 3);
+
+    ColumnDelta delta = ColumnDiff::DiffImages(previous, next);
+    EXPECT_EQ(delta.mRuns.size(), 3u);
+    ColumnDiff::ApplyImage(previous, Transmit(delta));
+    EXPECT_EQ(previous, next);
+}
+
+TEST(ColumnDiff, BlockHashes)
+{
+    const MetaType type = MetaType::GenerateType<uint32_t>();
+    std::vector<uint32_t> lhs(200, 1), rhs(200, 1);
+    rhs[130] = 2;
+
+    std::vector<uint64_t> before = ColumnDiff::BlockHashes(type, lhs.data(), 200);
+    std::vector<uint64_t> after = ColumnDiff::BlockHashes(type, rhs.data(), 200);
+    ASSERT_EQ(before.size(), 4u);
+    EXPECT_EQ(before[0], after[0]);
+    EXPECT_EQ(before[1], after[1]);
+    EXPECT_NE(before[2], after[2]);
+    EXPECT_EQ(before[3], after[3]);
+}
+
+} // namespace
@@ -0,0 +1,126 @@
+/**
+ * @author Will Bender
+ *
+ ** Command buffers, including recording from several threads at once.
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "CommandBuffer.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY;
+};
+
+struct Velocity
+{
+    float mX, mY;
+};
+
+struct ThrowOnCopy
+{
+    ThrowOnCopy() = default;
+    ThrowOnCopy(const ThrowOnCopy&) { throw std::runtime_error("copy"); }
+    ThrowOnCopy& operator=(const ThrowOnCopy&) = default;
+};
+
+// Distinct component types per recording thread, so types are first registered while recording
+template<uint32_t N>
+struct ThreadComponent
+{
+    uint32_t mValue;
+};
+
+TEST(CommandQueue, ThrowingSpawnRecordsNothing)
+{
+    World world;
+    CommandQueue queue;
+    CommandBuffer& buffer = queue.Local();
+
+    ThrowOnCopy value;
+    EXPECT_THROW(buffer.Spawn(Position{1, 2}, value), std::runtime_error);
+    EXPECT_TRUE(buffer.Empty());
+
+    queue.Apply(world);
+    EXPECT_EQ(world.Size(), 0u);
+}
+
+TEST(CommandQueue, SpawnAndAdd)
+{
+    World world;
+    Entity entity = world.Spawn(Position{0, 0});
+
+    CommandQueue queue;
+    queue.Local().Spawn(Velocity{1, 1}, Position{2, 2});
+    queue.Local().Add(entity, Velocity{3, 3});
+    queue.Apply(world);
+
+    EXPECT_EQ(world.Size(), 2u);
+    ASSERT_NE(world.Get<Velocity>(entity), nullptr);
+    EXPECT_EQ(world.Get<Velocity>(entity)->mX, 3);
+    EXPECT_EQ((world.Query<const Position, const Velocity>().Size()), 2u);
+}
+
+TEST(CommandQueue, LocalBufferPerQueueAndThread)
+{
+    CommandQueue first;
+    CommandQueue second;
+    CommandBuffer& a = first.Local();
+    CommandBuffer& b = second.Local();
+
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(&first.Local(), &a);
+    EXPECT_EQ(&second.Local(), &b);
+
+    CommandBuffer* other = nullptr;
+    std::thread([&]() { other = &first.Local(); }).join();
+    EXPECT_NE(other, &a);
+}
+
+template<uint32_t N>
+void Record(CommandQueue& queue, Entity entity, uint32_t count)
+{
+    CommandBuffer& buffer = queue.Local();
+    for (uint32_t i = 0; i < count; ++i)
+        buffer.Spawn(ThreadComponent<N>{i}, Position{float(i), 0});
+
+    ThreadComponent<N + 100> value{N};
+    buffer.Add(entity, MetaTypeRegistry::GetId<ThreadComponent<N + 100>>(), &value);
+}
+
+TEST(CommandQueue, ConcurrentRecording)
+{
+    constexpr uint32_t Count = 1000;
+
+    World world;
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < 4; ++i)
+        entities.push_back(world.Spawn(Position{0, 0}));
+
+    CommandQueue queue;
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() { Record<0>(queue, entities[0], Count); });
+    threads.emplace_back([&]() { Record<1>(queue, entities[1], Count); });
+    threads.emplace_back([&]() { Record<2>(queue, entities[2], Count); });
+    threads.emplace_back([&]() { Record<3>(queue, entities[3], Count); });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    queue.Apply(world);
+    EXPECT_EQ(world.Size(), 4 + 4 * Count);
+    EXPECT_EQ(world.Query<const ThreadComponent<2>>().Size(), Count);
+    ASSERT_NE(world.Get<ThreadComponent<103>>(entities[3]), nullptr);
+    EXPECT_EQ(world.Get<ThreadComponent<103>>(entities[3])->mValue, 3u);
+}
+
+} // namespace
@@ -0,0 +1,110 @@
+/**
+ * @author Will Bender
+ *
+ ** EpochSlotMap reclamation, including readers racing a writer.
+ *
+ * Build with `-DELECTRP_SANITIZE=thread` and `-DELECTRP_SANITIZE=address,undefined` to check ordering and lifetimes.
+ * ThreadSanitizer does not model the standalone fence in `Read`, it only sees the seq_cst compare-exchange before it.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "EpochSlotMap.hpp"
+
+namespace
+{
+
+// Value marking itself dead on destruction, so readers notice values reclaimed under them
+struct Tracked
+{
+    explicit Tracked(uint64_t value) : mValue(value) {}
+    Tracked(Tracked&& other) noexcept : mValue(other.mValue) {}
+    ~Tracked() { mAlive.store(false, std::memory_order_relaxed); }
+
+    std::atomic<bool> mAlive{true};
+    uint64_t mValue;
+};
+
+TEST(EpochSlotMap, RemovedValuesOutliveReaders)
+{
+    EpochSlotMap<std::string> map;
+    EpochSlotMap<std::string>::Key key = map.Insert("a");
+    map.Insert("b");
+    {
+        auto reader = map.Read();
+        ASSERT_NE(reader.Find(key), nullptr);
+        EXPECT_EQ(*reader.Find(key), "a");
+
+        map.Remove(key);
+        EXPECT_EQ(reader.Find(key), nullptr);
+
+        // Still pinned by the reader
+        map.Collect();
+        EXPECT_EQ(map.RetiredCount(), 1u);
+    }
+    map.Collect();
+    EXPECT_EQ(map.RetiredCount(), 0u);
+
+    // The slot is reused with a new generation once reclaimed
+    EpochSlotMap<std::string>::Key reused = map.Insert("c");
+    EXPECT_EQ(reused.mIndex, key.mIndex);
+    EXPECT_NE(reused.mGeneration, key.mGeneration);
+
+    uint32_t count = 0;
+    map.Read().ForEach([&count](auto, const std::string&) { ++count; });
+    EXPECT_EQ(count, 2u);
+}
+
+TEST(EpochSlotMap, ReadersRaceWriter)
+{
+    EpochSlotMap<Tracked> map;
+    std::atomic<bool> stop(false);
+    std::atomic<bool> reclaimedWhileRead(false);
+
+    std::vector<std::thread> readers;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&]()
+        {
+            while (!stop.load())
+            {
+                auto reader = map.Read();
+                reader.ForEach([&](auto, const Tracked& value)
+                {
+                    if (!value.mAlive.load(std::memory_order_relaxed))
+                        reclaimedWhileRead = true;
+                });
+            }
+        });
+    }
+
+    std::vector<EpochSlotMap<Tracked>::Key> keys;
+    for (uint64_t i = 0; i < 100000; ++i)
+    {
+        keys.push_back(map.Insert(Tracked(i)));
+        if (keys.size() > 3000)
+        {
+            size_t index = i * 7919 % keys.size();
+            ASSERT_TRUE(map.Remove(keys[index]));
+            keys[index] = keys.back();
+            keys.pop_back();
+        }
+    }
+    stop = true;
+    for (std::thread& reader : readers)
+        reader.join();
+
+    EXPECT_FALSE(reclaimedWhileRead.load());
+    map.Collect();
+    map.Collect();
+    EXPECT_EQ(map.Size(), keys.size());
+    EXPECT_EQ(map.RetiredCount(), 0u);
+}
+
+} // namespace
@@ -0,0 +1,84 @@
+/**
+ * @author Will Bender
+ *
+ ** Memory accounting, built with `METATYPE_MEMORY_ACCOUNTING` defined.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "MemoryAccounting.hpp"
+#include "MetaTypeRegistry.hpp"
+#include "Slotmap.hpp"
+
+namespace
+{
+
+// Registering a type must not require operations its containers never use
+struct NoDefault
+{
+    explicit NoDefault(int value) : mValue(value) {}
+
+    int mValue;
+};
+
+struct MoveOnly
+{
+    explicit MoveOnly(int value) : mValue(std::make_unique<int>(value)) {}
+
+    std::unique_ptr<int> mValue;
+};
+
+const MemoryStats* Find(const std::vector<MemoryStats>& stats, uint64_t typeId)
+{
+    for (const MemoryStats& stat : stats)
+    {
+        if (stat.mTypeId == typeId)
+            return &stat;
+    }
+    return nullptr;
+}
+
+TEST(MemoryAccounting, Enabled)
+{
+    EXPECT_TRUE(MemoryAccounting::Enabled);
+}
+
+TEST(MemoryAccounting, SlotMapOfNonDefaultConstructible)
+{
+    SlotMap<NoDefault> map;
+    SlotMap<NoDefault>::TypedKey key = map.insert(NoDefault(7));
+    EXPECT_EQ(map.find(key)->mValue, 7);
+
+    const MetaType& type = MetaTypeRegistry::Get(MetaTypeRegistry::GetId<NoDefault>());
+    EXPECT_EQ(type.mDefaultConstruct, nullptr);
+    EXPECT_NE(type.mCopyConstruct, nullptr);
+
+    std::vector<MemoryStats> stats = MemoryAccounting::Collect();
+    const MemoryStats* stat = Find(stats, TypeId<NoDefault>());
+    ASSERT_NE(stat, nullptr);
+    EXPECT_EQ(stat->mName, TypeName<NoDefault>());
+    EXPECT_GT(stat->mCapacityBytes, 0);
+}
+
+TEST(MemoryAccounting, MoveOnlyKernels)
+{
+    const MetaType& type = MetaTypeRegistry::Get(MetaTypeRegistry::GetId<MoveOnly>());
+    EXPECT_EQ(type.mCopyConstruct, nullptr);
+    EXPECT_EQ(type.mCopyAssign, nullptr);
+    EXPECT_EQ(type.mGather, nullptr);
+    EXPECT_EQ(type.mScatter, nullptr);
+    ASSERT_NE(type.mRelocate, nullptr);
+
+    alignas(MoveOnly) unsigned char src[sizeof(MoveOnly)];
+    alignas(MoveOnly) unsigned char dst[sizeof(MoveOnly)];
+    new (src) MoveOnly(3);
+    type.mRelocate(src, dst, 1);
+    EXPECT_EQ(*reinterpret_cast<MoveOnly*>(dst)->mValue, 3);
+    type.mDestruct(dst, 1);
+}
+
+} // namespace
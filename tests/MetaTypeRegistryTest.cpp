@@ -0,0 +1,80 @@
+/**
+ * @author Will Bender
+ *
+ ** MetaTypeRegistry registration and concurrent lookup.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "MetaTypeRegistry.hpp"
+
+namespace
+{
+
+template<uint32_t N>
+struct Tag
+{
+    uint32_t mValue;
+};
+
+struct Registered
+{
+    MetaTypeRegistry::Id mId;
+    uint64_t mTypeId;
+};
+
+template<uint32_t... Ns>
+std::vector<Registered> RegisterAll(std::integer_sequence<uint32_t, Ns...>)
+{
+    return {Registered{MetaTypeRegistry::GetId<Tag<Ns>>(), TypeId<Tag<Ns>>()}...};
+}
+
+TEST(MetaTypeRegistry, IdsAreStableAndDense)
+{
+    MetaTypeRegistry::Id id = MetaTypeRegistry::GetId<Tag<1000>>();
+    EXPECT_EQ(MetaTypeRegistry::GetId<const Tag<1000>>(), id);
+    EXPECT_EQ(MetaTypeRegistry::Register<Tag<1000>>(), id);
+    EXPECT_EQ(MetaTypeRegistry::Find(TypeId<Tag<1000>>()), id);
+    EXPECT_EQ(MetaTypeRegistry::Get(id).mTypeId, TypeId<Tag<1000>>());
+    EXPECT_LT(id, MetaTypeRegistry::Size());
+    EXPECT_EQ(MetaTypeRegistry::Find(0), MetaTypeRegistry::InvalidId);
+}
+
+TEST(MetaTypeRegistry, ConcurrentRegistrationAndLookup)
+{
+    // Enough types to allocate several pages while other threads read
+    constexpr uint32_t Types = MetaTypeRegistry::PageSize * 2 + 16;
+    constexpr uint32_t Readers = 3;
+
+    MetaTypeRegistry::Id known = MetaTypeRegistry::GetId<Tag<2000>>();
+    std::atomic<bool> done = false;
+
+    std::vector<std::thread> readers;
+    for (uint32_t t = 0; t < Readers; ++t)
+    {
+        readers.emplace_back([&]()
+        {
+            while (!done.load(std::memory_order_relaxed))
+                EXPECT_EQ(MetaTypeRegistry::Get(known).mTypeId, TypeId<Tag<2000>>());
+        });
+    }
+
+    std::vector<Registered> registered = RegisterAll(std::make_integer_sequence<uint32_t, Types>());
+    done = true;
+    for (std::thread& thread : readers)
+        thread.join();
+
+    for (const Registered& type : registered)
+    {
+        EXPECT_EQ(MetaTypeRegistry::Get(type.mId).mTypeId, type.mTypeId);
+        EXPECT_EQ(MetaTypeRegistry::Find(type.mTypeId), type.mId);
+    }
+}
+
+} // namespace
@@ -0,0 +1,298 @@
+/**
+ * @author Will Bender
+ *
+ ** MetaType lifecycle, comparison and copy hooks.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "MetaType.hpp"
+
+namespace
+{
+
+// Points at itself and counts live instances, so a memcpy relocation or a missed destructor shows up
+struct SelfRef
+{
+    explicit SelfRef(int value) : mSelf(this), mValue(value) { ++Live; }
+    SelfRef(const SelfRef& other) : mSelf(this), mValue(other.mValue) { ++Live; }
+    SelfRef(SelfRef&& other) noexcept : mSelf(this), mValue(other.mValue) { ++Live; }
+    SelfRef& operator=(const SelfRef& other)
+    {
+        mValue = other.mValue;
+        return *this;
+    }
+    ~SelfRef() { --Live; }
+
+    bool Valid() const { return mSelf == this; }
+
+    static inline int Live = 0;
+
+    SelfRef* mSelf;
+    int mValue;
+};
+
+// Uninitialized storage for an array of `T`
+template<typename T>
+struct Storage
+{
+    explicit Storage(uint32_t count) : mBytes(sizeof(T) * count) {}
+
+    T* Data() { return reinterpret_cast<T*>(mBytes.data()); }
+    T& operator[](uint32_t index) { return Data()[index]; }
+
+    std::vector<std::aligned_storage_t<sizeof(T), alignof(T)>> mBytes;
+};
+
+TEST(MetaType, RelocateNonTrivialType)
+{
+    const MetaType type = MetaType::GenerateType<SelfRef>();
+    EXPECT_FALSE(type.mTriviallyRelocatable);
+    EXPECT_FALSE(type.mTriviallyDestructible);
+
+    Storage<SelfRef> src(4), dst(4);
+    for (int i = 0; i < 4; ++i)
+        new (&src[i]) SelfRef(i);
+    ASSERT_EQ(SelfRef::Live, 4);
+
+    type.RelocateValues(src.Data(), dst.Data(), 4);
+    EXPECT_EQ(SelfRef::Live, 4);
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(dst[i].Valid());
+        EXPECT_EQ(dst[i].mValue, i);
+    }
+
+    type.DestructValues(dst.Data(), 4);
+    EXPECT_EQ(SelfRef::Live, 0);
+}
+
+TEST(MetaType, SwapRemoveDestructsOnce)
+{
+    const MetaType type = MetaType::GenerateType<SelfRef>();
+
+    Storage<SelfRef> column(4);
+    for (int i = 0; i < 4; ++i)
+        new (&column[i]) SelfRef(i);
+
+    // The removed value and the relocated source are both destructed
+    type.SwapRemove(column.Data(), 1, 3);
+    EXPECT_EQ(SelfRef::Live, 3);
+    EXPECT_EQ(column[0].mValue, 0);
+    EXPECT_EQ(column[1].mValue, 3);
+    EXPECT_EQ(column[2].mValue, 2);
+    EXPECT_TRUE(column[1].Valid());
+
+    // Removing the last value only destructs it
+    type.SwapRemove(column.Data(), 2, 2);
+    EXPECT_EQ(SelfRef::Live, 2);
+
+    type.DestructValues(column.Data(), 2);
+    EXPECT_EQ(SelfRef::Live, 0);
+}
+
+TEST(MetaType, SwapRemoveString)
+{
+    const MetaType type = MetaType::GenerateType<std::string>();
+    EXPECT_FALSE(type.mTriviallyRelocatable);
+
+    // Long enough to live on the heap, so a leak or double free is caught by the sanitizers
+    Storage<std::string> column(3);
+    for (int i = 0; i < 3; ++i)
+        new (&column[i]) std::string(32, char('a' + i));
+    // Short enough for the small buffer, which points into the string itself
+    column[2] = "c";
+
+    type.SwapRemove(column.Data(), 0, 2);
+    EXPECT_EQ(column[0], "c");
+    EXPECT_EQ(column[1], std::string(32, 'b'));
+
+    Storage<std::string> moved(2);
+    type.RelocateValues(column.Data(), moved.Data(), 2);
+    EXPECT_EQ(moved[0], "c");
+    EXPECT_EQ(moved[1], std::string(32, 'b'));
+    type.DestructValues(moved.Data(), 2);
+}
+
+struct Pair
+{
+    uint32_t mA, mB;
+};
+
+// Padding between the fields, compared through `operator==`
+struct Padded
+{
+    uint8_t mA;
+    uint32_t mB;
+
+    bool operator==(const Padded& other) const { return mA == other.mA && mB == other.mB; }
+};
+
+TEST(MetaType, EqualsAndHashOfBytes)
+{
+    const MetaType type = MetaType::GenerateType<Pair>();
+    ASSERT_NE(type.mEquals, nullptr);
+    ASSERT_NE(type.mHash, nullptr);
+
+    std::vector<Pair> lhs, rhs;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        lhs.push_back({i, i * 3});
+        rhs.push_back({i, i * 3});
+    }
+    EXPECT_TRUE(type.mEquals(lhs.data(), rhs.data(), 100));
+    EXPECT_EQ(type.mHash(lhs.data(), 100, 1), type.mHash(rhs.data(), 100, 1));
+    EXPECT_NE(type.mHash(lhs.data(), 100, 1), type.mHash(lhs.data(), 100, 2));
+    EXPECT_NE(type.mHash(lhs.data(), 100, 1), type.mHash(lhs.data(), 99, 1));
+
+    rhs[97].mB = 0;
+    EXPECT_FALSE(type.mEquals(lhs.data(), rhs.data(), 100));
+    EXPECT_TRUE(type.mEquals(lhs.data(), rhs.data(), 97));
+    EXPECT_NE(type.mHash(lhs.data(), 100, 1), type.mHash(rhs.data(), 100, 1));
+}
+
+TEST(MetaType, EqualsAndHashOfNonTrivialType)
+{
+    const MetaType type = MetaType::GenerateType<std::string>();
+    ASSERT_NE(type.mEquals, nullptr);
+    ASSERT_NE(type.mHash, nullptr);
+
+    // Equal strings in separate heap buffers, whose bytes differ
+    std::vector<std::string> lhs = {std::string(40, 'a'), "b", ""};
+    std::vector<std::string> rhs = {std::string(40, 'a'), "b", ""};
+    EXPECT_NE(std::memcmp(lhs.data(), rhs.data(), sizeof(std::string)), 0);
+    EXPECT_TRUE(type.mEquals(lhs.data(), rhs.data(), 3));
+    EXPECT_EQ(type.mHash(lhs.data(), 3, 0), type.mHash(rhs.data(), 3, 0));
+
+    rhs[1] = "c";
+    EXPECT_FALSE(type.mEquals(lhs.data(), rhs.data(), 3));
+    EXPECT_NE(type.mHash(lhs.data(), 3, 0), type.mHash(rhs.data(), 3, 0));
+}
+
+TEST(MetaType, EqualsIgnoresRepresentation)
+{
+    // Padding bytes differ, the fields do not
+    Padded lhs, rhs;
+    std::memset(&lhs, 0x00, sizeof(Padded));
+    std::memset(&rhs, 0xFF, sizeof(Padded));
+    lhs.mA = rhs.mA = 1;
+    lhs.mB = rhs.mB = 2;
+
+    const MetaType padded = MetaType::GenerateType<Padded>();
+    EXPECT_TRUE(padded.mEquals(&lhs, &rhs, 1));
+    // No `std::hash`, so no hash consistent with `operator==`
+    EXPECT_EQ(padded.mHash, nullptr);
+
+    // Equal values with different bits
+    const MetaType floats = MetaType::GenerateType<float>();
+    float zero = 0.0f, negativeZero = -0.0f;
+    EXPECT_TRUE(floats.mEquals(&zero, &negativeZero, 1));
+    EXPECT_EQ(floats.mHash(&zero, 1, 0), floats.mHash(&negativeZero, 1, 0));
+}
+
+struct Point
+{
+    int32_t mX, mY;
+
+    bool operator==(const Point& other) const { return mX == other.mX && mY == other.mY; }
+};
+
+template<typename T>
+bool operator==(const Storage<T>& lhs, const std::vector<T>& rhs)
+{
+    for (uint32_t i = 0; i < rhs.size(); ++i)
+    {
+        if (!(const_cast<Storage<T>&>(lhs)[i] == rhs[i]))
+            return false;
+    }
+    return true;
+}
+
+// Compares every copy hook of a type against a scalar loop over the same values
+template<typename T, typename MakeValue>
+void ExpectCopyHooksMatchLoop(MakeValue make)
+{
+    const MetaType type = MetaType::GenerateType<T>();
+    constexpr uint32_t Count = 9;
+
+    // Interleaved source, one value per struct
+    struct Interleaved
+    {
+        uint32_t mBefore;
+        T mValue;
+        uint16_t mAfter;
+    };
+    std::vector<Interleaved> source;
+    std::vector<T> values;
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        source.push_back({i, make(i), uint16_t(i)});
+        values.push_back(make(i));
+    }
+    const size_t stride = sizeof(Interleaved);
+
+    Storage<T> strided(Count);
+    type.mCopyConstructStrided(&source[0].mValue, stride, strided.Data(), sizeof(T), Count);
+    EXPECT_TRUE(strided == values);
+
+    // A stride of 0 repeats one value
+    Storage<T> repeated(Count);
+    type.mCopyConstructStrided(&source[4].mValue, 0, repeated.Data(), sizeof(T), Count);
+    EXPECT_TRUE(repeated == std::vector<T>(Count, values[4]));
+
+    std::vector<Interleaved> movedFrom = source;
+    Storage<T> moved(Count);
+    type.mMoveConstructStrided(&movedFrom[0].mValue, stride, moved.Data(), sizeof(T), Count);
+    EXPECT_TRUE(moved == values);
+
+    const std::vector<uint32_t> indices = {5, 0, 8, 3, 3};
+    Storage<T> gathered(uint32_t(indices.size()));
+    type.mGather(values.data(), indices.data(), gathered.Data(), uint32_t(indices.size()));
+    std::vector<T> expected;
+    for (uint32_t index : indices)
+        expected.push_back(values[index]);
+    EXPECT_TRUE(gathered == expected);
+
+    std::vector<T> scattered(Count, make(100)), scalar(Count, make(100));
+    const std::vector<uint32_t> targets = {6, 1, 2};
+    type.mScatter(values.data(), scattered.data(), targets.data(), uint32_t(targets.size()));
+    for (uint32_t i = 0; i < targets.size(); ++i)
+        scalar[targets[i]] = values[i];
+    EXPECT_EQ(scattered, scalar);
+
+    type.DestructValues(strided.Data(), Count);
+    type.DestructValues(repeated.Data(), Count);
+    type.DestructValues(moved.Data(), Count);
+    type.DestructValues(gathered.Data(), uint32_t(indices.size()));
+}
+
+TEST(MetaType, CopyHooksOfTrivialType)
+{
+    ExpectCopyHooksMatchLoop<Point>([](uint32_t i) { return Point{int32_t(i), -int32_t(i)}; });
+
+    // Trivial types accept strides that do not keep values aligned
+    const MetaType type = MetaType::GenerateType<uint32_t>();
+    std::vector<uint8_t> packed(5 * 4);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        uint32_t value = i * 1000;
+        std::memcpy(packed.data() + i * 5 + 1, &value, sizeof(value));
+    }
+    std::vector<uint32_t> unpacked(4);
+    type.mCopyConstructStrided(packed.data() + 1, 5, unpacked.data(), sizeof(uint32_t), 4);
+    EXPECT_EQ(unpacked, (std::vector<uint32_t>{0, 1000, 2000, 3000}));
+}
+
+TEST(MetaType, CopyHooksOfNonTrivialType)
+{
+    ExpectCopyHooksMatchLoop<std::string>([](uint32_t i) { return std::string(40, char('a' + i)); });
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+/**
+ * @author Will Bender
+ *
+ ** Systems scheduled over a world.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "Scheduler.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY;
+};
+
+struct Velocity
+{
+    float mX, mY;
+};
+
+TEST(Scheduler, WorldIdsAreUnique)
+{
+    std::optional<World> world;
+    world.emplace();
+    uint64_t first = world->GetId();
+    world.reset();
+    world.emplace();
+    EXPECT_NE(world->GetId(), first);
+    EXPECT_EQ(world->Query<Position>().GetWorldId(), world->GetId());
+}
+
+TEST(Scheduler, CachedViewFollowsNewWorldAtSameAddress)
+{
+    ThreadPool pool(2);
+    Scheduler scheduler(pool);
+    std::atomic<uint32_t> visited(0);
+    scheduler.AddSystem<const Position>("count", [&visited](const Position&) { ++visited; });
+
+    // Both worlds live at the same address, the second with a different archetype order
+    std::optional<World> world;
+    world.emplace();
+    for (uint32_t i = 0; i < 10; ++i)
+        world->Spawn(Position{0, 0});
+    scheduler.Run(*world);
+    EXPECT_EQ(visited.load(), 10u);
+
+    World* address = &*world;
+    world.reset();
+    world.emplace();
+    ASSERT_EQ(&*world, address);
+    world->Spawn(Velocity{0, 0});
+    for (uint32_t i = 0; i < 3; ++i)
+        world->Spawn(Position{0, 0}, Velocity{0, 0});
+
+    visited = 0;
+    scheduler.Run(*world);
+    EXPECT_EQ(visited.load(), 3u);
+}
+
+TEST(Scheduler, FailingSystemStillFinishesFrame)
+{
+    ThreadPool pool(2);
+    Scheduler scheduler(pool);
+    std::atomic<uint32_t> dependentRuns(0);
+    scheduler.AddSystem<Position>("fail", [](Position&) { throw std::runtime_error("system failed"); });
+    scheduler.AddSystem<Position>("dependent", [&dependentRuns](Position&) { ++dependentRuns; });
+    ASSERT_EQ(scheduler.GetDependencies(1).size(), 1u);
+
+    World world;
+    world.Spawn(Position{0, 0});
+    EXPECT_THROW(scheduler.Run(world), std::runtime_error);
+    EXPECT_EQ(dependentRuns.load(), 1u);
+}
+
+} // namespace
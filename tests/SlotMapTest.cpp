@@ -0,0 +1,219 @@
+/**
+ * @author Will Bender
+ *
+ ** SlotMap iteration, removal, copy and serialization.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Slotmap.hpp"
+
+namespace
+{
+
+using Map = SlotMap<int>;
+
+std::vector<int> Values(const Map& map)
+{
+    std::vector<int> out;
+    for (const int& value : map)
+        out.push_back(value);
+    return out;
+}
+
+TEST(SlotMap, IterationSkipsFreeNodes)
+{
+    Map map;
+    std::vector<Map::TypedKey> keys;
+    for (int i = 0; i < 6; ++i)
+        keys.push_back(map.insert(int(i)));
+
+    // Leading, middle and trailing free nodes
+    map.remove(keys[0]);
+    map.remove(keys[2]);
+    map.remove(keys[3]);
+    map.remove(keys[5]);
+
+    EXPECT_EQ(Values(map), (std::vector<int>{1, 4}));
+    EXPECT_EQ(map.Size(), 2u);
+
+    std::vector<int> mutableValues;
+    for (int& value : map)
+        mutableValues.push_back(value);
+    EXPECT_EQ(mutableValues, (std::vector<int>{1, 4}));
+}
+
+TEST(SlotMap, EmptyAfterRemovingEverything)
+{
+    Map map;
+    Map::TypedKey key = map.insert(1);
+    map.remove(key);
+
+    EXPECT_TRUE(map.begin() == map.end());
+    EXPECT_TRUE(Values(map).empty());
+}
+
+TEST(SlotMap, TryRemoveRejectsStaleKeys)
+{
+    Map map;
+    Map::TypedKey key = map.insert(1);
+
+    EXPECT_TRUE(map.TryRemove(key));
+    EXPECT_FALSE(map.TryRemove(key));
+    EXPECT_FALSE(map.TryRemove(Map::Key(0, 100)));
+
+    // The slot is reused with a new generation
+    Map::TypedKey reused = map.insert(2);
+    EXPECT_EQ(reused.GetIndex(), key.GetIndex());
+    EXPECT_NE(reused.GetGeneration(), key.GetGeneration());
+    EXPECT_FALSE(map.contains(key));
+    EXPECT_TRUE(map.contains(reused));
+}
+
+TEST(SlotMap, EraseWhileIterating)
+{
+    Map map;
+    for (int i = 0; i < 10; ++i)
+        map.insert(int(i));
+
+    for (Map::iterator iter = map.begin(); iter != map.end();)
+    {
+        if (*iter % 2 == 0)
+            map.erase(iter);
+        else
+            ++iter;
+    }
+    EXPECT_EQ(Values(map), (std::vector<int>{1, 3, 5, 7, 9}));
+
+    const Map& constMap = map;
+    Map::const_iterator first = constMap.begin();
+    map.erase(first);
+    EXPECT_EQ(Values(map), (std::vector<int>{3, 5, 7, 9}));
+    EXPECT_EQ(map.Size(), 4u);
+}
+
+TEST(SlotMap, IteratorKeysFindValues)
+{
+    Map map;
+    for (int i = 0; i < 4; ++i)
+        map.insert(int(i * 10));
+
+    for (Map::iterator iter = map.begin(); iter != map.end(); ++iter)
+        EXPECT_EQ(*map.find(iter.GetKey()), *iter);
+}
+
+TEST(SlotMap, Copy)
+{
+    Map map{1, 2, 3};
+    map.remove(map.begin().GetKey());
+
+    Map copy(map);
+    EXPECT_EQ(Values(copy), (std::vector<int>{2, 3}));
+    EXPECT_EQ(copy.Size(), 2u);
+
+    // Copies own their nodes
+    *copy.begin() = 20;
+    EXPECT_EQ(Values(map), (std::vector<int>{2, 3}));
+
+    std::vector<int> source = {4, 5};
+    Map fromRange(source);
+    EXPECT_EQ(Values(fromRange), source);
+}
+
+TEST(SlotMap, SerializeRoundTrip)
+{
+    Map map;
+    std::vector<Map::TypedKey> keys;
+    for (int i = 0; i < 8; ++i)
+        keys.push_back(map.insert(int(i)));
+    map.remove(keys[1]);
+    map.remove(keys[6]);
+
+    std::vector<uint8_t> bytes;
+    map.Serialize(bytes);
+
+    Map loaded;
+    EXPECT_EQ(loaded.Deserialize(bytes.data(), bytes.data() + bytes.size()), bytes.data() + bytes.size());
+    EXPECT_EQ(Values(loaded), Values(map));
+    EXPECT_FALSE(loaded.contains(keys[1]));
+    EXPECT_TRUE(loaded.contains(keys[2]));
+
+    // Free slots are reused in the same order
+    EXPECT_EQ(loaded.insert(100).mKey, map.insert(100).mKey);
+}
+
+TEST(SlotMap, DeserializeRejectsOversizedCount)
+{
+    Map map;
+    map.insert(1);
+    std::vector<uint8_t> bytes;
+    map.Serialize(bytes);
+
+    // A count whose byte size wraps around to a few bytes must not pass the size check
+    constexpr uint64_t record = sizeof(unsigned) + 1 + std::max(sizeof(int), sizeof(size_t));
+    uint64_t count = UINT64_MAX / record + 1;
+    std::memcpy(bytes.data(), &count, sizeof(count));
+
+    Map loaded;
+    EXPECT_THROW(loaded.Deserialize(bytes.data(), bytes.data() + bytes.size()), std::runtime_error);
+}
+
+TEST(SlotMap, DeserializeRejectsCorruptFreeList)
+{
+    Map map;
+    std::vector<Map::TypedKey> keys;
+    for (int i = 0; i < 4; ++i)
+        keys.push_back(map.insert(int(i)));
+    map.remove(keys[1]);
+    map.remove(keys[3]);
+
+    std::vector<uint8_t> bytes;
+    map.Serialize(bytes);
+
+    // Header of node count, free list head and size, followed by the generation, occupancy and value columns
+    constexpr size_t slot = std::max(sizeof(int), sizeof(size_t));
+    const size_t values = 3 * sizeof(uint64_t) + 4 * (sizeof(unsigned) + 1);
+    auto corrupt = [&](size_t offset, uint64_t value, size_t size)
+    {
+        std::vector<uint8_t> out = bytes;
+        std::memcpy(out.data() + offset, &value, size);
+        return out;
+    };
+
+    std::vector<std::vector<uint8_t>> inputs = {
+        // Head out of range
+        corrupt(sizeof(uint64_t), 4, sizeof(uint64_t)),
+        // Head at an occupied node
+        corrupt(sizeof(uint64_t), 0, sizeof(uint64_t)),
+        // Link out of range, from the head at node 3
+        corrupt(values + 3 * slot, 100, sizeof(size_t)),
+        // Link back to itself
+        corrupt(values + 3 * slot, 3, sizeof(size_t)),
+        // Size not matching the occupied nodes
+        corrupt(2 * sizeof(uint64_t), 3, sizeof(uint64_t)),
+    };
+    for (const std::vector<uint8_t>& input : inputs)
+    {
+        Map loaded{7};
+        EXPECT_THROW(loaded.Deserialize(input.data(), input.data() + input.size()), std::runtime_error);
+        // Failed loads leave the map unchanged
+        EXPECT_EQ(Values(loaded), std::vector<int>{7});
+    }
+
+    Map loaded;
+    loaded.Deserialize(bytes.data(), bytes.data() + bytes.size());
+    EXPECT_EQ(Values(loaded), (std::vector<int>{0, 2}));
+    loaded.insert(10);
+    loaded.insert(11);
+    loaded.insert(12);
+    EXPECT_EQ(loaded.Size(), 5u);
+}
+
+} // namespace
@@ -0,0 +1,224 @@
+/**
+ * @author Will Bender
+ *
+ ** World snapshots, including malformed input.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Snapshot.hpp"
+
+namespace
+{
+
+struct Position
+{
+    float mX, mY;
+};
+
+// Non-trivial component with serialization hooks, counting its live values
+struct Name
+{
+    static inline int32_t sLive = 0;
+
+    explicit Name(std::string value) : mValue(std::move(value)) { ++sLive; }
+    Name(const Name& other) : mValue(other.mValue) { ++sLive; }
+    Name(Name&& other) noexcept : mValue(std::move(other.mValue)) { ++sLive; }
+    Name& operator=(const Name& other) = default;
+    Name& operator=(Name&& other) noexcept = default;
+    ~Name() { --sLive; }
+
+    void Serialize(std::vector<uint8_t>& out) const
+    {
+        uint32_t size = static_cast<uint32_t>(mValue.size());
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&size);
+        out.insert(out.end(), bytes, bytes + sizeof(size));
+        out.insert(out.end(), mValue.begin(), mValue.end());
+    }
+
+    static const uint8_t* Deserialize(const uint8_t* in, const uint8_t* end, Name* dst)
+    {
+        uint32_t size;
+        if (end - in < static_cast<ptrdiff_t>(sizeof(size)))
+            throw std::runtime_error("Name cut short");
+        std::memcpy(&size, in, sizeof(size));
+        in += sizeof(size);
+        if (static_cast<size_t>(end - in) < size)
+            throw std::runtime_error("Name cut short");
+        new (dst) Name(std::string(reinterpret_cast<const char*>(in), size));
+        return in + size;
+    }
+
+    std::string mValue;
+};
+
+void Populate(World& world)
+{
+    for (uint32_t i = 0; i < 300; ++i)
+        world.Spawn(Position{float(i), 0});
+    for (uint32_t i = 0; i < 300; ++i)
+        world.Spawn(Position{float(i), 1}, Name("entity " + std::to_string(i)));
+}
+
+TEST(Snapshot, RoundTrip)
+{
+    std::vector<uint8_t> bytes;
+    {
+        World world;
+        Populate(world);
+        WorldSnapshot::Save(world, bytes);
+    }
+    EXPECT_EQ(Name::sLive, 0);
+
+    World world;
+    WorldSnapshot::Load(world, bytes);
+    EXPECT_EQ(world.Size(), 600u);
+    EXPECT_EQ(Name::sLive, 300);
+
+    uint32_t named = 0;
+    world.Query<const Position, const Name>().ForEach(
+        [&named](const Position& position, const Name& name)
+        {
+            named += name.mValue == "entity " + std::to_string(int(position.mX));
+        });
+    EXPECT_EQ(named, 300u);
+}
+
+TEST(Snapshot, TruncatedInputLeavesWorldEmpty)
+{
+    std::vector<uint8_t> bytes;
+    {
+        World world;
+        Populate(world);
+        WorldSnapshot::Save(world, bytes);
+    }
+
+    World world;
+    for (size_t size = 0; size < bytes.size(); size += 97)
+    {
+        EXPECT_THROW(WorldSnapshot::Load(world, bytes.data(), size), std::runtime_error);
+        EXPECT_EQ(world.Size(), 0u);
+        EXPECT_EQ(Name::sLive, 0);
+        EXPECT_EQ((world.Query<const Position>().Size()), 0u);
+    }
+
+    // The world is still usable after a failed load
+    WorldSnapshot::Load(world, bytes);
+    EXPECT_EQ(world.Size(), 600u);
+    EXPECT_EQ(Name::sLive, 300);
+}
+
+// Reads or overwrites a value at a byte offset of a snapshot
+template<typename T>
+T& At(std::vector<uint8_t>& bytes, size_t offset)
+{
+    return *reinterpret_cast<T*>(bytes.data() + offset);
+}
+
+TEST(Snapshot, CorruptCountsAreRejected)
+{
+    std::vector<uint8_t> bytes;
+    size_t provider;
+    {
+        World world;
+        for (uint32_t i = 0; i < 10; ++i)
+            world.Spawn(Position{float(i), 0});
+        world.Despawn(world.Spawn(Position{0, 0}));
+        WorldSnapshot::Save(world, bytes);
+
+        std::vector<uint8_t> entities;
+        world.GetEntities().Serialize(entities);
+        provider = entities.size();
+    }
+
+    // Offsets of the entity free list head, and of the entity count of the only archetype
+    const size_t freeList = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+    const size_t entities = 2 * sizeof(uint32_t) + provider + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+    ASSERT_EQ(At<uint32_t>(bytes, entities), 10u);
+
+    auto expectRejected = [](const std::vector<uint8_t>& input)
+    {
+        World world;
+        EXPECT_THROW(WorldSnapshot::Load(world, input), std::runtime_error);
+        EXPECT_EQ(world.Size(), 0u);
+        // The world stays usable
+        world.Spawn(Position{0, 0});
+        EXPECT_EQ(world.Size(), 1u);
+    };
+
+    std::vector<uint8_t> corrupt = bytes;
+    At<uint64_t>(corrupt, freeList) = 1000;
+    expectRejected(corrupt);
+
+    // Large enough to overflow the table count of the archetype
+    corrupt = bytes;
+    At<uint32_t>(corrupt, entities) = 0xFFFFFFF0u;
+    expectRejected(corrupt);
+
+    // More rows than entities, with enough input to hold their columns
+    corrupt = bytes;
+    At<uint32_t>(corrupt, entities) = 11;
+    corrupt.resize(corrupt.size() + sizeof(Position) + sizeof(EntityKey));
+    expectRejected(corrupt);
+
+    // Fewer rows than entities
+    corrupt = bytes;
+    At<uint32_t>(corrupt, entities) = 9;
+    corrupt.resize(corrupt.size() - sizeof(Position) - sizeof(EntityKey));
+    expectRejected(corrupt);
+
+    // One entity stored twice, leaving another without a row
+    corrupt = bytes;
+    size_t keys = corrupt.size() - 10 * sizeof(EntityKey);
+    At<EntityKey>(corrupt, keys + sizeof(EntityKey)) = At<EntityKey>(corrupt, keys);
+    expectRejected(corrupt);
+}
+
+TEST(Snapshot, CorruptBytesNeverCrash)
+{
+    std::vector<uint8_t> bytes;
+    {
+        World world;
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            world.Spawn(Position{float(i), 0});
+            world.Spawn(Position{float(i), 1}, Name("entity " + std::to_string(i)));
+        }
+        world.Despawn(world.Spawn(Position{0, 0}));
+        WorldSnapshot::Save(world, bytes);
+    }
+
+    // Every byte replaced with a few values. Loads either succeed with a consistent world or throw.
+    for (size_t offset = 0; offset < bytes.size(); ++offset)
+    {
+        for (uint8_t value : {uint8_t(0x00), uint8_t(0x01), uint8_t(0x80), uint8_t(0xFF)})
+        {
+            std::vector<uint8_t> corrupt = bytes;
+            corrupt[offset] = value;
+
+            World world;
+            try
+            {
+                WorldSnapshot::Load(world, corrupt);
+            }
+            catch (const std::runtime_error&)
+            {
+                EXPECT_EQ(world.Size(), 0u);
+                EXPECT_EQ(Name::sLive, 0);
+                continue;
+            }
+            EXPECT_EQ(world.Size(), 12u);
+            EXPECT_EQ(world.Query<const Position>().Size(), 12u);
+            world.Spawn(Position{0, 0});
+        }
+    }
+    EXPECT_EQ(Name::sLive, 0);
+}
+
+} // namespace
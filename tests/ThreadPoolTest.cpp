@@ -0,0 +1,66 @@
+/**
+ * @author Will Bender
+ *
+ ** ThreadPool completion and exception propagation.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "ThreadPool.hpp"
+
+namespace
+{
+
+TEST(ThreadPool, ParallelForRunsEveryChunk)
+{
+    ThreadPool pool(3);
+    std::atomic<uint32_t> sum(0);
+    pool.ParallelFor(1000, 7, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            sum.fetch_add(i, std::memory_order_relaxed);
+    });
+    EXPECT_EQ(sum.load(), 999u * 1000u / 2u);
+}
+
+TEST(ThreadPool, WaitRethrowsTaskException)
+{
+    for (uint32_t workers : {1u, 3u})
+    {
+        ThreadPool pool(workers);
+        ThreadPool::Counter counter(3);
+        std::atomic<uint32_t> finished(0);
+        pool.Submit([&] { ++finished; }, &counter);
+        pool.Submit([] { throw std::runtime_error("task failed"); }, &counter);
+        pool.Submit([&] { ++finished; }, &counter);
+
+        // The counter still reaches zero, then the exception is rethrown
+        EXPECT_THROW(pool.Wait(counter), std::runtime_error);
+        EXPECT_EQ(counter.load(), 0u);
+        EXPECT_EQ(finished.load(), 2u);
+
+        // The exception is only reported once
+        ThreadPool::Counter next(1);
+        pool.Submit([] {}, &next);
+        EXPECT_NO_THROW(pool.Wait(next));
+    }
+}
+
+TEST(ThreadPool, ParallelForRethrowsChunkException)
+{
+    ThreadPool pool(3);
+    std::atomic<uint32_t> chunks(0);
+    EXPECT_THROW(pool.ParallelFor(100, 10, [&](uint32_t begin, uint32_t)
+    {
+        ++chunks;
+        if (begin == 50)
+            throw std::runtime_error("chunk failed");
+    }), std::runtime_error);
+    EXPECT_EQ(chunks.load(), 10u);
+}
+
+} // namespace
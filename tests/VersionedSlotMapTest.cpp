@@ -0,0 +1,100 @@
+/**
+ * @author Will Bender
+ *
+ ** VersionedSlotMap snapshots, including snapshots read on other threads while the owner writes.
+ *
+ * Build with `-DELECTRP_SANITIZE=thread` and `-DELECTRP_SANITIZE=address,undefined` to check copy-on-write sharing.
+ */
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "VersionedSlotMap.hpp"
+
+namespace
+{
+
+using Map = VersionedSlotMap<std::string>;
+
+std::vector<Map::Key> Fill(Map& map, uint32_t count)
+{
+    std::vector<Map::Key> keys;
+    for (uint32_t i = 0; i < count; ++i)
+        keys.push_back(map.Insert(std::to_string(i)));
+    return keys;
+}
+
+TEST(VersionedSlotMap, SnapshotsAreUnaffectedByWrites)
+{
+    Map map;
+    std::vector<Map::Key> keys = Fill(map, 1000);
+    auto snapshot = map.Snapshot();
+
+    *map.Find(keys[3]) = "changed";
+    map.Remove(keys[700]);
+    Map::Key added = map.Insert("new");
+    EXPECT_EQ(added.mIndex, keys[700].mIndex);
+
+    EXPECT_EQ(*snapshot.Find(keys[3]), "3");
+    EXPECT_EQ(*snapshot.Find(keys[700]), "700");
+    EXPECT_EQ(snapshot.Find(added), nullptr);
+    EXPECT_EQ(snapshot.Size(), 1000u);
+
+    EXPECT_EQ(*map.Find(keys[3]), "changed");
+    EXPECT_EQ(map.Find(keys[700]), nullptr);
+    EXPECT_EQ(*map.Find(added), "new");
+    EXPECT_FALSE(map.Remove(keys[700]));
+
+    uint32_t count = 0;
+    snapshot.ForEach([&count](auto, const std::string&) { ++count; });
+    EXPECT_EQ(count, 1000u);
+}
+
+TEST(VersionedSlotMap, CopiesDoNotShareWrites)
+{
+    Map map;
+    std::vector<Map::Key> keys = Fill(map, 10);
+    Map copy = map;
+    *copy.Find(keys[1]) = "copy";
+    EXPECT_EQ(*map.Find(keys[1]), "1");
+}
+
+TEST(VersionedSlotMap, SnapshotReadersRaceWriter)
+{
+    Map map;
+    std::vector<Map::Key> keys = Fill(map, 1000);
+
+    std::vector<std::thread> readers;
+    std::vector<size_t> lengths(4);
+    for (size_t& length : lengths)
+    {
+        readers.emplace_back([snapshot = map.Snapshot(), &length]()
+        {
+            for (uint32_t pass = 0; pass < 50; ++pass)
+                snapshot.ForEach([&length](auto, const std::string& value) { length += value.size(); });
+        });
+    }
+
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        if (std::string* value = map.Find(keys[i % keys.size()]))
+            *value += "x";
+        if (i % 100 == 0)
+            map.Snapshot();
+    }
+    for (std::thread& reader : readers)
+        reader.join();
+
+    // Every reader saw the values as they were when its snapshot was taken
+    size_t expected = 0;
+    for (uint32_t i = 0; i < 1000; ++i)
+        expected += std::to_string(i).size();
+    for (size_t length : lengths)
+        EXPECT_EQ(length, expected * 50);
+}
+
+} // namespace
@@ -0,0 +1,202 @@
+/**
+ * @author Will Bender
+ *
+ ** World structural changes through cached archetype edges, and views over archetypes created after them.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "World.hpp"
+
+namespace
+{
+
+struct Position
+{
+    uint32_t mValue;
+};
+
+struct Name
+{
+    std::string mValue;
+};
+
+struct Tag
+{
+    uint32_t mValue;
+};
+
+std::vector<ComponentId> Components(std::vector<ComponentId> components)
+{
+    std::sort(components.begin(), components.end());
+    return components;
+}
+
+uint32_t ArchetypeOf(World& world, Entity entity)
+{
+    return world.GetEntities().find(entity).get().mArchetype;
+}
+
+// Long enough to be heap allocated, so a value relocated with the wrong row is caught by the sanitizers
+std::string NameOf(uint32_t i)
+{
+    return "entity with a long enough name " + std::to_string(i);
+}
+
+// Every entity's location must point at a row holding that entity
+void ExpectLocationsValid(World& world, const std::vector<Entity>& entities)
+{
+    for (const Entity& entity : entities)
+    {
+        ArchetypeEntity location = world.GetEntities().find(entity).get();
+        const Table& table = world.GetArchetype(location.mArchetype).GetTable(location.mTable);
+        ASSERT_LT(location.mRow, table.Size());
+        EXPECT_EQ(table.GetEntities()[location.mRow], entity.mKey);
+    }
+}
+
+TEST(World, CachedEdgesMatchLookup)
+{
+    const ComponentId position = MetaTypeRegistry::GetId<Position>();
+    const ComponentId name = MetaTypeRegistry::GetId<Name>();
+    const ComponentId tag = MetaTypeRegistry::GetId<Tag>();
+
+    World world;
+    Entity a = world.Spawn(Position{1});
+    Entity b = world.Spawn(Position{2});
+    Archetype& source = world.GetArchetype(Components({position}));
+    EXPECT_EQ(source.GetAddEdge(tag), Archetype::InvalidArchetype);
+
+    // The first add takes the slow path and caches both directions
+    world.Add(a, Tag{1});
+    Archetype& withTag = world.GetArchetype(Components({position, tag}));
+    EXPECT_EQ(ArchetypeOf(world, a), withTag.GetIndex());
+    EXPECT_EQ(source.GetAddEdge(tag), withTag.GetIndex());
+    EXPECT_EQ(withTag.GetRemoveEdge(tag), source.GetIndex());
+
+    uint32_t archetypes = world.ArchetypeCount();
+    world.Add(b, Tag{2});
+    EXPECT_EQ(ArchetypeOf(world, b), withTag.GetIndex());
+    world.Remove<Tag>(b);
+    EXPECT_EQ(ArchetypeOf(world, b), source.GetIndex());
+    EXPECT_EQ(world.ArchetypeCount(), archetypes);
+
+    // A remove edge taken before its add edge
+    world.Add(a, Name{"a"});
+    world.Remove<Tag>(a);
+    Archetype& withName = world.GetArchetype(Components({position, name}));
+    EXPECT_EQ(ArchetypeOf(world, a), withName.GetIndex());
+    EXPECT_EQ(withName.GetAddEdge(tag), world.GetArchetype(Components({position, name, tag})).GetIndex());
+    world.Add(a, Tag{3});
+    EXPECT_EQ(ArchetypeOf(world, a), world.GetArchetype(Components({position, name, tag})).GetIndex());
+
+    EXPECT_EQ(world.Get<Position>(a)->mValue, 1u);
+    EXPECT_EQ(world.Get<Name>(a)->mValue, "a");
+    EXPECT_EQ(world.Get<Tag>(a)->mValue, 3u);
+}
+
+TEST(World, BatchedChangesAcrossTables)
+{
+    World world;
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < 3000; ++i)
+        entities.push_back(world.Spawn(Position{i}, Name{NameOf(i)}));
+
+    const uint32_t rows = world.GetArchetype(
+        Components({MetaTypeRegistry::GetId<Position>(), MetaTypeRegistry::GetId<Name>()})).GetLayout().mRowCount;
+    ASSERT_LT(rows * 2, entities.size());
+
+    // Selected rows are spread over every table, and include the tail
+    std::vector<Entity> selected;
+    for (uint32_t i = 0; i < entities.size(); ++i)
+    {
+        if (i % 3 == 0 || i + 10 >= entities.size())
+            selected.push_back(entities[i]);
+    }
+    world.Add(selected, Tag{7});
+    ExpectLocationsValid(world, entities);
+
+    // Entities that already have the component have it replaced
+    std::vector<Entity> again(selected.begin(), selected.begin() + 5);
+    world.Add(again, Tag{8});
+
+    for (uint32_t i = 0; i < entities.size(); ++i)
+    {
+        bool tagged = i % 3 == 0 || i + 10 >= entities.size();
+        ASSERT_EQ(world.Has<Tag>(entities[i]), tagged) << i;
+        EXPECT_EQ(world.Get<Position>(entities[i])->mValue, i);
+        EXPECT_EQ(world.Get<Name>(entities[i])->mValue, NameOf(i));
+        if (tagged)
+        {
+            EXPECT_EQ(world.Get<Tag>(entities[i])->mValue, i < 15 ? 8u : 7u);
+        }
+    }
+
+    std::vector<Entity> removed;
+    for (uint32_t i = 0; i < entities.size(); i += 2)
+        removed.push_back(entities[i]);
+    world.Remove<Tag>(removed);
+    ExpectLocationsValid(world, entities);
+
+    for (uint32_t i = 0; i < entities.size(); ++i)
+    {
+        bool tagged = (i % 3 == 0 || i + 10 >= entities.size()) && i % 2 != 0;
+        EXPECT_EQ(world.Has<Tag>(entities[i]), tagged) << i;
+        EXPECT_EQ(world.Get<Position>(entities[i])->mValue, i);
+        EXPECT_EQ(world.Get<Name>(entities[i])->mValue, NameOf(i));
+    }
+    EXPECT_EQ(world.Size(), entities.size());
+}
+
+TEST(World, ViewPicksUpNewArchetypes)
+{
+    World world;
+    View<const Position, Opt<Tag>> view = world.Query<const Position, Opt<Tag>>();
+    EXPECT_EQ(view.Size(), 0u);
+
+    // Each group of entities creates its archetypes after the view has been refreshed, and places the optional
+    // column at a different offset
+    std::vector<Entity> entities;
+    const uint32_t group = 1500;
+    for (uint32_t i = 0; i < group; ++i)
+        entities.push_back(world.Spawn(Position{i}));
+    EXPECT_EQ(view.Size(), group);
+    for (uint32_t i = group; i < group * 2; ++i)
+        entities.push_back(world.Spawn(Position{i}, Tag{i * 2}));
+    EXPECT_EQ(view.Size(), group * 2);
+    for (uint32_t i = group * 2; i < group * 3; ++i)
+        entities.push_back(world.Spawn(Name{NameOf(i)}, Position{i}, Tag{i * 2}));
+    world.Spawn(Name{"unmatched"});
+
+    const uint32_t rows = world.GetArchetype(Components({MetaTypeRegistry::GetId<Position>()})).GetLayout().mRowCount;
+    ASSERT_LT(rows, group);
+
+    std::vector<bool> seen(entities.size(), false);
+    view.ForEachEntity([&](Entity entity, const Position& position, Tag* tag)
+    {
+        ASSERT_LT(position.mValue, entities.size());
+        EXPECT_EQ(entity, entities[position.mValue]);
+        EXPECT_FALSE(seen[position.mValue]);
+        seen[position.mValue] = true;
+
+        if (position.mValue < group)
+        {
+            EXPECT_EQ(tag, nullptr);
+        }
+        else
+        {
+            ASSERT_NE(tag, nullptr);
+            EXPECT_EQ(tag, world.Get<Tag>(entity));
+            EXPECT_EQ(tag->mValue, position.mValue * 2);
+        }
+    });
+    EXPECT_EQ(view.Size(), entities.size());
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), static_cast<ptrdiff_t>(entities.size()));
+}
+
+} // namespace
@@ -0,0 +1,98 @@
+/**
+ * @author Will Bender
+ *
+ ** Per-table zone summaries and filtered queries.
+ */
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "World.hpp"
+
+namespace
+{
+
+struct Health
+{
+    int32_t mValue;
+};
+
+} // namespace
+
+template<>
+struct ZoneTraits<Health>
+{
+    using Summary = ZoneRange<int32_t>;
+
+    static Summary Empty() { return Summary::Empty(); }
+    static void Include(Summary& summary, const Health& health) { summary.Include(health.mValue); }
+};
+
+namespace
+{
+
+constexpr uint32_t Count = 20000;
+
+// Count entities with health in `[min, max]`, returning the number of tables visited through `tables`
+uint32_t CountWhere(World& world, int32_t min, int32_t max, uint32_t* tables = nullptr)
+{
+    uint32_t out = 0;
+    uint32_t visited = 0;
+    world.Query<const Health>().ForEachTableWhere<Health>(
+        [&](const ZoneRange<int32_t>& zone) { return zone.Overlaps(min, max); },
+        [&](uint32_t count, const EntityKey*, const Health* health)
+        {
+            ++visited;
+            for (uint32_t i = 0; i < count; ++i)
+                out += health[i].mValue >= min && health[i].mValue <= max;
+        });
+    if (tables)
+        *tables = visited;
+    return out;
+}
+
+TEST(ZoneMap, SkipsTablesAndTracksWrites)
+{
+    World world;
+    for (uint32_t i = 0; i < Count; ++i)
+        world.Spawn(Health{int32_t(i)});
+
+    uint32_t all = 0;
+    uint32_t few = 0;
+    EXPECT_EQ(CountWhere(world, 0, int32_t(Count), &all), Count);
+    EXPECT_EQ(CountWhere(world, 0, 9, &few), 10u);
+    EXPECT_LT(few, all);
+
+    // Mutable iteration invalidates the summaries it hands out
+    world.Query<Health>().ForEach([](Health& health) { health.mValue = -health.mValue; });
+    EXPECT_EQ(CountWhere(world, 0, 9), 1u);
+    EXPECT_EQ(CountWhere(world, -9, 0), 10u);
+}
+
+TEST(ZoneMap, ConcurrentReadersRebuildOnce)
+{
+    World world;
+    for (uint32_t i = 0; i < Count; ++i)
+        world.Spawn(Health{int32_t(i)});
+
+    for (int32_t round = 0; round < 20; ++round)
+    {
+        // Leave every summary stale, so the readers race to rebuild them
+        world.Query<Health>().ForEach([](Health& health) { ++health.mValue; });
+
+        uint32_t counts[2] = {};
+        std::vector<std::thread> threads;
+        for (uint32_t& count : counts)
+            threads.emplace_back([&world, &count, round]() { count = CountWhere(world, 100 + round, 199 + round); });
+        for (std::thread& thread : threads)
+            thread.join();
+
+        EXPECT_EQ(counts[0], 100u);
+        EXPECT_EQ(counts[1], 100u);
+    }
+}
+
+} // namespace